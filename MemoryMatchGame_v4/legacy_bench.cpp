@@ -0,0 +1,123 @@
+//benchmarks MemoryMatchGame_1, _2 and _3 in the same csv as memorymatchgame_v4 --bench
+//each version's main.cpp is compiled into its own namespace with main renamed,
+//only the functions the old versions have are timed: initializeGame, displayBoard, checkMatch, isValidMove
+#include <iostream>
+#include <map>
+#include <set>
+#include <list>
+#include <stack>
+#include <queue>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <limits>
+#include <string>
+#include <vector>
+
+#define main legacy_main
+namespace v1
+{
+#include "../MemoryMatchGame_1/main.cpp"
+}
+namespace v2
+{
+#include "../MemoryMatchGame_2/main.cpp"
+}
+namespace v3
+{
+#include "../MemoryMatchGame_3/main.cpp"
+}
+#undef main
+
+using namespace std;
+
+//time fn until at least 20 ms have passed, returns nanoseconds per call
+template <typename F>
+double timePerCall(F fn, long long& iterations)
+{
+    iterations = 1;
+    while (true)
+    {
+        auto start = chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; i++)
+        {
+            fn();
+        }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        if (ns >= 2e7 || iterations >= (1ll << 40))
+        {
+            return ns / iterations;
+        }
+        iterations *= 2;
+    }
+}
+
+//streambuf that drops everything, cout is pointed at it while a board is drawn
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    streamsize xsputn(const char*, streamsize count) override
+    {
+        return count;
+    }
+};
+
+//time one version's engine on boards from 4x4 to 256x256, V is the namespace holding that version
+//and drawLevels the last level its displayBoard can draw
+#define BENCH_VERSION(V, drawLevels)                                                                              \
+    for (int size = 4; size <= 256; size *= 2)                                                                    \
+    {                                                                                                             \
+        int level = size / 2;                                                                                     \
+        int cells = size * size;                                                                                  \
+        long long iterations;                                                                                     \
+        auto report = [&](const string& name, double ns)                                                          \
+        {                                                                                                         \
+            cout << #V "," << name << "," << size << "x" << size << "," << cells << "," << iterations << ","      \
+                 << ns << "\n";                                                                                   \
+        };                                                                                                        \
+        /*every deal pushes a copy of the board for undo, pop it so the stack does not grow*/                     \
+        report("initializeGame", timePerCall([&] { V::initializeGame(level); V::gameState.pop(); }, iterations)); \
+        V::initializeGame(level);                                                                                 \
+        if (level <= drawLevels)                                                                                  \
+        {                                                                                                         \
+            streambuf* saved = cout.rdbuf(&nullBuffer);                                                           \
+            double ns = timePerCall([&] { V::displayBoard(); }, iterations);                                      \
+            cout.rdbuf(saved);                                                                                    \
+            report("displayBoard", ns);                                                                           \
+        }                                                                                                         \
+        vector<pair<int, int>> probes;                                                                            \
+        for (int k = 0; k < 1024; k++)                                                                            \
+        {                                                                                                         \
+            int idx = rng() % cells;                                                                              \
+            probes.push_back({idx / size, idx % size});                                                           \
+        }                                                                                                         \
+        size_t probe = 0;                                                                                         \
+        report("isValidMove", timePerCall([&]                                                                     \
+        {                                                                                                         \
+            auto move = probes[probe++ & 1023];                                                                   \
+            sink += V::isValidMove(move.first, move.second, true);                                                \
+        }, iterations));                                                                                          \
+        V::flipped.insert({0, 0});                                                                                \
+        V::flipped.insert({0, 1});                                                                                \
+        report("checkMatch", timePerCall([&] { sink += V::checkMatch(); }, iterations));                          \
+        V::flipped.clear();                                                                                       \
+        V::gameState = {};                                                                                        \
+    }
+
+int main()
+{
+    cout << "version,benchmark,board,cells,iterations,ns_per_op\n";
+    NullBuffer nullBuffer;
+    mt19937 rng(2024);
+    volatile long long sink = 0;//keeps results alive
+    BENCH_VERSION(v1, v1::MAX_LEVELS)//version 1 draws a level background and has none past its last level
+    BENCH_VERSION(v2, numeric_limits<int>::max())
+    BENCH_VERSION(v3, numeric_limits<int>::max())
+    return 0;
+}
@@ -11,30 +11,353 @@
 #include <limits>
 #include <iterator>
 #include <vector>
+#include <array>
 #include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <charconv>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
 using namespace std;
 
 //constants and global variables
 const int MAX_LEVELS = 8;//maximum number of levels
-int currentBoardSize = 4;//current board size, adjusted per level
-map<pair<int, int>, int> board;//stores card values at (row, col)
-set<pair<int, int>> flipped;//tracks currently flipped cards
-set<pair<int, int>> matched;//tracks permanently matched cards
+const int MAX_BOARD_SIDE = 4096;//largest custom board side
+const long long BANNER_EXACT_PAIRS = 1024;//custom boards with more pairs show the asymptotic par, the exact one takes seconds
 list<int> cardPool;//temporary storage for card values
-queue<pair<int, int>> moveHistory;//move sequence for validation
-map<int, int> levelScores;//best scores (fewest turns) per level
-int hintsRemaining = 0;//hints remaining for current level
-int totalMoves = 0;//total moves (card selections) in a level
-unordered_map<int, vector<pair<int, int>>> cardPositions;//hash table for card positions
+
+//dense row-major board storage, one int per cell
+struct Board
+{
+    int rows;//number of rows
+    int cols;//number of columns
+    vector<int> cells;//card values, row-major
+
+    Board() : rows(0), cols(0) {}
+
+    //resize the board, reusing storage where possible
+    void resize(int r, int c)
+    {
+        rows = r;
+        cols = c;
+        cells.assign(r * c, 0);
+    }
+
+    //flat index of a cell
+    int index(int row, int col) const
+    {
+        return row * cols + col;
+    }
+
+    //card value at (row, col)
+    int& at(int row, int col)
+    {
+        return cells[row * cols + col];
+    }
+
+    int at(int row, int col) const
+    {
+        return cells[row * cols + col];
+    }
+
+    int size() const
+    {
+        return rows * cols;
+    }
+};
+
+//per-cell hidden/flipped/matched state kept as two bit planes
+struct CellStates
+{
+    vector<uint64_t> flippedBits;//one bit per cell, set while face up
+    vector<uint64_t> matchedBits;//one bit per cell, set once matched
+    vector<int> flippedCells;//flipped cells in selection order
+    int matchedCount;//number of matched cells
+
+    CellStates() : matchedCount(0) {}
+
+    //reset every cell to hidden
+    void reset(int cellCount)
+    {
+        int words = (cellCount + 63) / 64;
+        flippedBits.assign(words, 0);
+        matchedBits.assign(words, 0);
+        flippedCells.clear();
+        flippedCells.reserve(2);
+        matchedCount = 0;
+    }
+
+    bool isFlipped(int idx) const
+    {
+        return (flippedBits[idx >> 6] >> (idx & 63)) & 1;
+    }
+
+    bool isMatched(int idx) const
+    {
+        return (matchedBits[idx >> 6] >> (idx & 63)) & 1;
+    }
+
+    //hidden cells are neither face up nor matched
+    bool isHidden(int idx) const
+    {
+        return !(((flippedBits[idx >> 6] | matchedBits[idx >> 6]) >> (idx & 63)) & 1);
+    }
+
+    //turn a hidden card face up
+    void flip(int idx)
+    {
+        flippedBits[idx >> 6] |= uint64_t(1) << (idx & 63);
+        flippedCells.push_back(idx);
+    }
+
+    //turn the most recently flipped card face down again, nothing if no card is up
+    void unflipLast()
+    {
+        if (flippedCells.empty()) return;
+        int idx = flippedCells.back();
+        flippedBits[idx >> 6] &= ~(uint64_t(1) << (idx & 63));
+        flippedCells.pop_back();
+    }
+
+    //turn every flipped card face down
+    void clearFlipped()
+    {
+        for (int idx : flippedCells)
+        {
+            flippedBits[idx >> 6] &= ~(uint64_t(1) << (idx & 63));
+        }
+        flippedCells.clear();
+    }
+
+    //mark a hidden cell as matched without flipping it, used for blank filler cells
+    void markMatched(int idx)
+    {
+        matchedBits[idx >> 6] |= uint64_t(1) << (idx & 63);
+        matchedCount++;
+    }
+
+    //move every flipped card to the matched plane
+    void matchFlipped()
+    {
+        for (int idx : flippedCells)
+        {
+            uint64_t bit = uint64_t(1) << (idx & 63);
+            flippedBits[idx >> 6] &= ~bit;
+            matchedBits[idx >> 6] |= bit;
+        }
+        matchedCount += flippedCells.size();
+        flippedCells.clear();
+    }
+
+    //return matched cells to hidden, used to undo a turn
+    void unmatch(const int* cells, int count)
+    {
+        for (int n = 0; n < count; n++)
+        {
+            matchedBits[cells[n] >> 6] &= ~(uint64_t(1) << (cells[n] & 63));
+        }
+        matchedCount -= count;
+    }
+};
+
+//board scans over the two state planes and the value array, in scalar, sse2 and avx2 versions chosen
+//once at startup from what the cpu supports
+struct ScanKernels
+{
+    const char* name;//instruction set in use
+    //first hidden cell at or after from, -1 if none
+    int (*firstHidden)(const uint64_t* flipped, const uint64_t* matched, int cells, int from);
+    //what count cells from start show: 0 hidden, the card value face up or matched, -1 for blank filler
+    void (*visibleRow)(const int* values, const uint64_t* flipped, const uint64_t* matched, int start, int count, int* out);
+
+    //bits [idx, idx + 64) of a plane, reading past the last word as zeros
+    static uint64_t bitsFrom(const uint64_t* words, int wordCount, int idx)
+    {
+        int word = idx >> 6;
+        int shift = idx & 63;
+        uint64_t low = word < wordCount ? words[word] >> shift : 0;
+        uint64_t high = shift && word + 1 < wordCount ? words[word + 1] << (64 - shift) : 0;
+        return low | high;
+    }
+
+    static int firstHiddenScalar(const uint64_t* flipped, const uint64_t* matched, int cells, int from)
+    {
+        int words = (cells + 63) / 64;
+        for (int w = from >> 6; w < words; w++)
+        {
+            uint64_t hidden = ~(flipped[w] | matched[w]);
+            if (w == from >> 6)
+            {
+                hidden &= ~uint64_t(0) << (from & 63);
+            }
+            if (hidden)
+            {
+                int idx = w * 64 + __builtin_ctzll(hidden);
+                return idx < cells ? idx : -1;
+            }
+        }
+        return -1;
+    }
+
+    static void visibleRowScalar(const int* values, const uint64_t* flipped, const uint64_t* matched, int start, int count, int* out)
+    {
+        for (int n = 0; n < count; n++)
+        {
+            int idx = start + n;
+            bool shown = ((flipped[idx >> 6] | matched[idx >> 6]) >> (idx & 63)) & 1;
+            out[n] = shown ? (values[idx] ? values[idx] : -1) : 0;
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    //the partial first word in scalar, then whole words two at a time
+    __attribute__((target("sse2")))
+    static int firstHiddenSse2(const uint64_t* flipped, const uint64_t* matched, int cells, int from)
+    {
+        int words = (cells + 63) / 64;
+        int w = from >> 6;
+        if (w < words && (from & 63))
+        {
+            uint64_t hidden = ~(flipped[w] | matched[w]) & (~uint64_t(0) << (from & 63));
+            if (hidden)
+            {
+                int idx = w * 64 + __builtin_ctzll(hidden);
+                return idx < cells ? idx : -1;
+            }
+            w++;
+        }
+        const __m128i ones = _mm_set1_epi32(-1);
+        for (; w + 2 <= words; w += 2)
+        {
+            __m128i shown = _mm_or_si128(_mm_loadu_si128((const __m128i*)(flipped + w)), _mm_loadu_si128((const __m128i*)(matched + w)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(shown, ones)) != 0xffff) break;
+        }
+        return firstHiddenScalar(flipped, matched, cells, min(w, words) * 64);
+    }
+
+    //four cells at a time: spread their state bits over the lanes and select value, -1 or 0
+    __attribute__((target("sse2")))
+    static void visibleRowSse2(const int* values, const uint64_t* flipped, const uint64_t* matched, int start, int count, int* out)
+    {
+        int words = (start + count + 63) / 64;
+        const __m128i lanes = _mm_set_epi32(8, 4, 2, 1);
+        const __m128i zero = _mm_setzero_si128();
+        int n = 0;
+        for (; n + 4 <= count; n += 4)
+        {
+            int idx = start + n;
+            int bits = (bitsFrom(flipped, words, idx) | bitsFrom(matched, words, idx)) & 15;
+            __m128i shown = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(bits), lanes), lanes);
+            __m128i value = _mm_loadu_si128((const __m128i*)(values + idx));
+            value = _mm_or_si128(value, _mm_cmpeq_epi32(value, zero));//blank filler becomes -1
+            _mm_storeu_si128((__m128i*)(out + n), _mm_and_si128(value, shown));
+        }
+        visibleRowScalar(values, flipped, matched, start + n, count - n, out + n);
+    }
+
+    //the partial first word in scalar, then whole words four at a time
+    __attribute__((target("avx2")))
+    static int firstHiddenAvx2(const uint64_t* flipped, const uint64_t* matched, int cells, int from)
+    {
+        int words = (cells + 63) / 64;
+        int w = from >> 6;
+        if (w < words && (from & 63))
+        {
+            uint64_t hidden = ~(flipped[w] | matched[w]) & (~uint64_t(0) << (from & 63));
+            if (hidden)
+            {
+                int idx = w * 64 + __builtin_ctzll(hidden);
+                return idx < cells ? idx : -1;
+            }
+            w++;
+        }
+        const __m256i ones = _mm256_set1_epi64x(-1);
+        for (; w + 4 <= words; w += 4)
+        {
+            __m256i shown = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(flipped + w)), _mm256_loadu_si256((const __m256i*)(matched + w)));
+            if (!_mm256_testc_si256(shown, ones)) break;
+        }
+        return firstHiddenScalar(flipped, matched, cells, min(w, words) * 64);
+    }
+
+    //eight cells at a time: spread their state bits over the lanes and select value, -1 or 0
+    __attribute__((target("avx2")))
+    static void visibleRowAvx2(const int* values, const uint64_t* flipped, const uint64_t* matched, int start, int count, int* out)
+    {
+        int words = (start + count + 63) / 64;
+        const __m256i lanes = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+        const __m256i zero = _mm256_setzero_si256();
+        int n = 0;
+        for (; n + 8 <= count; n += 8)
+        {
+            int idx = start + n;
+            int bits = (bitsFrom(flipped, words, idx) | bitsFrom(matched, words, idx)) & 255;
+            __m256i shown = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), lanes), lanes);
+            __m256i value = _mm256_loadu_si256((const __m256i*)(values + idx));
+            value = _mm256_or_si256(value, _mm256_cmpeq_epi32(value, zero));//blank filler becomes -1
+            _mm256_storeu_si256((__m256i*)(out + n), _mm256_and_si256(value, shown));
+        }
+        visibleRowScalar(values, flipped, matched, start + n, count - n, out + n);
+    }
+#endif
+
+    static ScanKernels scalar()
+    {
+        return {"scalar", firstHiddenScalar, visibleRowScalar};
+    }
+
+    //the widest kernels this cpu runs
+    static ScanKernels select()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return {"avx2", firstHiddenAvx2, visibleRowAvx2};
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return {"sse2", firstHiddenSse2, visibleRowSse2};
+        }
+#endif
+        return scalar();
+    }
+};
+
+ScanKernels scanKernels = ScanKernels::select();//board scans used by rendering and the solvers
 
 //binary search tree node for scores
 struct ScoreNode
 {
     int level;//level number
     int turns;//turns taken
-    ScoreNode* left;//left child
-    ScoreNode* right;//right child
-    ScoreNode(int l, int t) : level(l), turns(t), left(nullptr), right(nullptr) {}
+    int left;//index of left child in the node pool, -1 if none
+    int right;//index of right child in the node pool, -1 if none
+    ScoreNode(int l, int t) : level(l), turns(t), left(-1), right(-1) {}
 };
 
 //graph node for card relationships
@@ -44,535 +367,4063 @@ struct GraphNode
     vector<pair<int, int>> adjacent;//adjacent positions
 };
 
-//class to manage bst for scores
+//class to manage bst for scores, nodes live in one pool and link by index
 class ScoreBST
 {
 private:
-    ScoreNode* root;//root of the bst
+    vector<ScoreNode> nodes;//node pool, grows geometrically
+    int root;//index of the root, -1 when empty
+
+public:
+    ScoreBST() : root(-1) {}
 
-    //insert a node recursively
-    void insert(ScoreNode*& node, int level, int turns)
+    //insert a score, keeping the fewest turns per level
+    void insertScore(int level, int turns)
     {
-        if (!node)
+        int parent = -1;
+        int at = root;
+        while (at != -1)
         {
-            node = new ScoreNode(level, turns);
-            return;
+            ScoreNode& node = nodes[at];
+            if (level == node.level)
+            {
+                if (turns < node.turns)
+                {
+                    node.turns = turns;//update if fewer turns
+                }
+                return;
+            }
+            parent = at;
+            at = level < node.level ? node.left : node.right;
+        }
+        nodes.emplace_back(level, turns);
+        int added = nodes.size() - 1;
+        if (parent == -1)
+        {
+            root = added;
+        }
+        else if (level < nodes[parent].level)
+        {
+            nodes[parent].left = added;
         }
-        if (level < node->level)
+        else
+        {
+            nodes[parent].right = added;
+        }
+    }
+
+    //best turns for a level, -1 if the level has no score
+    int findBest(int level) const
+    {
+        int at = root;
+        while (at != -1)
+        {
+            const ScoreNode& node = nodes[at];
+            if (level == node.level) return node.turns;
+            at = level < node.level ? node.left : node.right;
+        }
+        return -1;
+    }
+
+    //all scores in level order
+    vector<pair<int, int>> getScores() const
+    {
+        vector<pair<int, int>> scores;
+        scores.reserve(nodes.size());
+        vector<int> path;//ancestors still to visit
+        int at = root;
+        while (at != -1 || !path.empty())
+        {
+            while (at != -1)
+            {
+                path.push_back(at);
+                at = nodes[at].left;
+            }
+            at = path.back();
+            path.pop_back();
+            scores.push_back({nodes[at].level, nodes[at].turns});
+            at = nodes[at].right;
+        }
+        return scores;
+    }
+};
+
+
+//cell indices of every copy of each card value, filled while dealing
+struct CardPositions
+{
+    vector<int> cells;//copies slots per value, value v starts at (v - 1) * copies
+    vector<int> filled;//copies placed so far for each value
+    int copies = 2;//cards per value
+
+    //clear for values 1..values, keeping capacity
+    void reset(int values, int perValue)
+    {
+        copies = perValue;
+        cells.assign(values * perValue, -1);
+        filled.assign(values + 1, 0);
+    }
+
+    //record that a copy of value sits at cell idx
+    void add(int value, int idx)
+    {
+        cells[(value - 1) * copies + filled[value]++] = idx;
+    }
+
+    //cell of the n-th copy of value
+    int at(int value, int n) const
+    {
+        return cells[(value - 1) * copies + n];
+    }
+};
+
+//small fast generator (wyrand) for dealing boards
+struct FastRng
+{
+    uint64_t state = 0;//generator state
+
+    void seed(uint64_t s)
+    {
+        state = s;
+    }
+
+    uint64_t next()
+    {
+        state += 0xa0761d6478bd642full;
+        __uint128_t product = __uint128_t(state) * (state ^ 0xe7037ed1a0b428dbull);
+        return uint64_t(product >> 64) ^ uint64_t(product);
+    }
+
+    //uniform value in [0, bound) without modulo bias (lemire's method)
+    uint32_t below(uint32_t bound)
+    {
+        uint64_t m = uint64_t(uint32_t(next() >> 32)) * bound;
+        uint32_t low = uint32_t(m);
+        if (low < bound)
         {
-            insert(node->left, level, turns);
+            uint32_t threshold = -bound % bound;
+            while (low < threshold)
+            {
+                m = uint64_t(uint32_t(next() >> 32)) * bound;
+                low = uint32_t(m);
+            }
         }
-        else if (level > node->level)
+        return m >> 32;
+    }
+};
+
+//fixed-size on-disk score record, an empty slot has level 0
+struct ScoreRecord
+{
+    char player[24];//player name, nul padded
+    int32_t level;//level number
+    int32_t turns;//fewest turns
+};
+
+//header at the start of the score file
+struct ScoreFileHeader
+{
+    char magic[8];//"MMSCORE1"
+    uint32_t capacity;//record slots, a power of two
+    uint32_t count;//slots in use
+};
+
+//memory-mapped open addressing table of best scores keyed by (player, level)
+class ScoreStore
+{
+private:
+    string path;//file backing the table
+    int fd;//open descriptor, -1 when closed
+    char* base;//start of the mapping
+    size_t length;//bytes mapped
+
+    ScoreFileHeader* header() const
+    {
+        return reinterpret_cast<ScoreFileHeader*>(base);
+    }
+
+    ScoreRecord* records() const
+    {
+        return reinterpret_cast<ScoreRecord*>(base + sizeof(ScoreFileHeader));
+    }
+
+    static size_t bytesFor(uint32_t capacity)
+    {
+        return sizeof(ScoreFileHeader) + size_t(capacity) * sizeof(ScoreRecord);
+    }
+
+    //fnv-1a over the name, mixed with the level
+    static uint32_t hashKey(const char* player, int level)
+    {
+        uint32_t h = 2166136261u;
+        for (int i = 0; i < 24 && player[i]; i++)
         {
-            insert(node->right, level, turns);
+            h = (h ^ uint8_t(player[i])) * 16777619u;
         }
-        else if (turns < node->turns)
+        return (h ^ uint32_t(level)) * 2654435761u;
+    }
+
+    //slot holding the key, or the empty slot where it belongs
+    ScoreRecord* probe(const char* player, int level) const
+    {
+        uint32_t mask = header()->capacity - 1;
+        uint32_t slot = hashKey(player, level) & mask;
+        while (true)
         {
-            node->turns = turns;//update if fewer turns
+            ScoreRecord* rec = records() + slot;
+            if (rec->level == 0 || (rec->level == level && strncmp(rec->player, player, 24) == 0))
+            {
+                return rec;
+            }
+            slot = (slot + 1) & mask;
         }
     }
 
-    //in-order traversal to collect scores
-    void inOrder(ScoreNode* node, vector<pair<int, int>>& scores)
+    //map a file of the given capacity, creating its header if it is new
+    bool mapFile(int file, uint32_t capacity, bool fresh)
     {
-        if (!node) return;
-        inOrder(node->left, scores);
-        scores.push_back({node->level, node->turns});
-        inOrder(node->right, scores);
+        size_t bytes = bytesFor(capacity);
+        if (fresh && ftruncate(file, bytes) != 0) return false;
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        if (mapped == MAP_FAILED) return false;
+        fd = file;
+        base = static_cast<char*>(mapped);
+        length = bytes;
+        if (fresh)
+        {
+            memcpy(header()->magic, "MMSCORE1", 8);
+            header()->capacity = capacity;
+            header()->count = 0;
+        }
+        return true;
     }
 
-    //clear the bst
-    void clear(ScoreNode* node)
+    //double the table into a new file and swap it in place of the old one
+    bool grow()
     {
-        if (!node) return;
-        clear(node->left);
-        clear(node->right);
-        delete node;
+        string tmpPath = path + ".tmp";
+        int file = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (file < 0) return false;
+        ScoreStore bigger;
+        bigger.path = tmpPath;
+        if (!bigger.mapFile(file, header()->capacity * 2, true))
+        {
+            ::close(file);
+            return false;
+        }
+        for (uint32_t i = 0; i < header()->capacity; i++)
+        {
+            const ScoreRecord& rec = records()[i];
+            if (rec.level != 0)
+            {
+                *bigger.probe(rec.player, rec.level) = rec;
+                bigger.header()->count++;
+            }
+        }
+        if (rename(tmpPath.c_str(), path.c_str()) != 0)
+        {
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        close();
+        fd = bigger.fd;
+        base = bigger.base;
+        length = bigger.length;
+        bigger.fd = -1;
+        bigger.base = nullptr;
+        return true;
     }
 
 public:
-    ScoreBST() : root(nullptr) {}
-    ~ScoreBST()
+    ScoreStore() : fd(-1), base(nullptr), length(0) {}
+    ~ScoreStore()
     {
-        clear(root);
+        close();
     }
 
-    //public method to insert score
-    void insertScore(int level, int turns)
+    //map the score file, creating it if missing, nothing is parsed
+    bool open(const string& file)
     {
-        insert(root, level, turns);
+        close();
+        path = file;
+        int handle = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (handle < 0) return false;
+        struct stat info;
+        if (fstat(handle, &info) != 0)
+        {
+            ::close(handle);
+            return false;
+        }
+        if (info.st_size == 0)
+        {
+            if (mapFile(handle, 1024, true)) return true;
+            ::close(handle);
+            return false;
+        }
+        ScoreFileHeader stored;
+        if (pread(handle, &stored, sizeof(stored), 0) != sizeof(stored) ||
+            memcmp(stored.magic, "MMSCORE1", 8) != 0 ||
+            stored.capacity == 0 || (stored.capacity & (stored.capacity - 1)) != 0 ||
+            stored.count > stored.capacity / 2 ||
+            size_t(info.st_size) < bytesFor(stored.capacity) ||
+            !mapFile(handle, stored.capacity, false))
+        {
+            ::close(handle);
+            return false;
+        }
+        return true;
     }
 
-    //public method to get scores
-    vector<pair<int, int>> getScores()
+    void close()
     {
-        vector<pair<int, int>> scores;
-        inOrder(root, scores);
-        return scores;
+        if (base)
+        {
+            munmap(base, length);
+            base = nullptr;
+        }
+        if (fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    bool isOpen() const
+    {
+        return base != nullptr;
+    }
+
+    //best turns recorded for the player on a level, -1 if none
+    int findBest(const string& player, int level) const
+    {
+        if (!base) return -1;
+        char key[24] = {};
+        strncpy(key, player.c_str(), sizeof(key) - 1);
+        const ScoreRecord* rec = probe(key, level);
+        return rec->level == 0 ? -1 : rec->turns;
+    }
+
+    //keep the fewer turns for (player, level), written straight into the mapping
+    void record(const string& player, int level, int turns)
+    {
+        if (!base) return;
+        char key[24] = {};
+        strncpy(key, player.c_str(), sizeof(key) - 1);
+        ScoreRecord* rec = probe(key, level);
+        if (rec->level != 0)
+        {
+            if (turns < rec->turns)
+            {
+                rec->turns = turns;
+            }
+            return;
+        }
+        if ((header()->count + 1) * 2 > header()->capacity)
+        {
+            if (!grow()) return;//past half full probe could run out of empty slots, so the score is dropped
+            rec = probe(key, level);
+        }
+        memcpy(rec->player, key, sizeof(key));
+        rec->turns = turns;
+        rec->level = level;
+        header()->count++;
+    }
+};
+
+//keeps the values of unmatched pairs for constant time hints
+class HintEngine
+{
+private:
+    vector<int> unmatchedValues;//values whose pair is still on the board
+    vector<int> slot;//position of each value in unmatchedValues, -1 once matched
+
+public:
+    //start a new board with values 1..pairs unmatched
+    void reset(int pairs)
+    {
+        unmatchedValues.clear();
+        slot.assign(pairs + 1, -1);
+        for (int v = 1; v <= pairs; v++)
+        {
+            slot[v] = unmatchedValues.size();
+            unmatchedValues.push_back(v);
+        }
+    }
+
+    //drop a value once its pair is matched, swapping the last value into its slot
+    void onMatched(int value)
+    {
+        int pos = slot[value];
+        if (pos < 0) return;
+        int last = unmatchedValues.back();
+        unmatchedValues[pos] = last;
+        slot[last] = pos;
+        unmatchedValues.pop_back();
+        slot[value] = -1;
+    }
+
+    //put a value back after its match was undone
+    void onUnmatched(int value)
+    {
+        if (slot[value] >= 0) return;
+        slot[value] = unmatchedValues.size();
+        unmatchedValues.push_back(value);
+    }
+
+    bool empty() const
+    {
+        return unmatchedValues.empty();
+    }
+
+    //any value that still has an unmatched pair
+    int anyUnmatched() const
+    {
+        return unmatchedValues.back();
+    }
+
+    const vector<int>& values() const
+    {
+        return unmatchedValues;
+    }
+};
+
+//bounded ring of completed turns for undo and redo, each entry keeps only the cells its turn flipped
+struct MoveJournal
+{
+    vector<int> cells;//capacity entries of width cells each
+    vector<uint8_t> matched;//entry's cells were matched
+    int width = 2;//cells flipped per turn
+    int capacity = 0;//entries kept, older turns fall off the back
+    int head = 0;//slot the next turn is written to
+    int undoable = 0;//entries behind head
+    int redoable = 0;//undone entries from head on
+
+    //start a new board, keeping at most 64k cells however wide the turns are
+    void reset(int matchSize)
+    {
+        width = matchSize;
+        capacity = max(1, min(256, 65536 / matchSize));
+        cells.resize(capacity * width);
+        matched.resize(capacity);
+        head = 0;
+        undoable = 0;
+        redoable = 0;
+    }
+
+    //journal a completed turn, dropping anything that could have been redone
+    void record(const vector<int>& flipped, bool match)
+    {
+        copy(flipped.begin(), flipped.end(), cells.begin() + head * width);
+        matched[head] = match;
+        head = head + 1 == capacity ? 0 : head + 1;
+        undoable = min(undoable + 1, capacity);
+        redoable = 0;
+    }
+
+    //step back over the newest turn, returns its slot
+    int undo()
+    {
+        head = head == 0 ? capacity - 1 : head - 1;
+        undoable--;
+        redoable++;
+        return head;
+    }
+
+    //step forward over the oldest undone turn, returns its slot
+    int redo()
+    {
+        int at = head;
+        head = head + 1 == capacity ? 0 : head + 1;
+        undoable++;
+        redoable--;
+        return at;
+    }
+
+    const int* turnCells(int at) const
+    {
+        return cells.data() + at * width;
+    }
+};
+
+bool adjacentHints = false;//only suggest pairs connected through hidden cells
+bool ansiRender = false;//redraw only changed cells using ansi cursor moves
+int revealMillis = 1000;//how long a mismatched pair stays face up
+
+//replay log events, each stored as one varint after the game header
+const uint64_t REPLAY_HINT = 0;//-1 -1
+const uint64_t REPLAY_QUIT = 1;//-9 -9
+const uint64_t REPLAY_RESTART = 2;//unreadable input, the turn starts over
+const uint64_t REPLAY_OFF_BOARD = 3;//selection outside the board
+const uint64_t REPLAY_UNDO = 4;//-2 -2
+const uint64_t REPLAY_REDO = 5;//-3 -3
+const uint64_t REPLAY_CELL = 6;//REPLAY_CELL + index of the selected cell
+const char REPLAY_MAGIC[4] = {'M', 'M', 'R', '2'};//starts every game in a replay log
+
+struct GameSession;
+using FrameBuilder = const string& (*)(GameSession& game);//builds a frame into game.renderer.frame
+
+//builds board frames into one reusable buffer, optionally as ansi diffs against the last frame
+struct BoardRenderer
+{
+    string frame;//output buffer, reused between frames
+    vector<int> shown;//value drawn in each cell last frame, 0 while hidden
+    vector<int> row;//what each cell of the row being drawn shows, as scanKernels.visibleRow fills it
+    string banner;//text kept above the board in ansi mode
+    int bannerLines = 0;//lines taken by the banner
+    bool ansi = false;//emit cursor-addressed diffs instead of full frames
+    bool drawn = false;//ansi mode: a full frame is on screen
+    FrameBuilder fixed = nullptr;//compile-time specialised classic frames for a built-in level, null for any other board
+
+    //force the next frame to be drawn in full under a new banner
+    void reset(const string& text)
+    {
+        banner = text;
+        bannerLines = count(text.begin(), text.end(), '\n');
+        drawn = false;
+    }
+};
+
+//result of reading one integer from the console
+enum InputStatus
+{
+    INPUT_OK,
+    INPUT_BAD,//token was not an integer, the rest of its line should be skipped
+    INPUT_EOF//stdin closed
+};
+
+//reads stdin with raw read calls into a fixed buffer and parses integers without iostreams,
+//many moves may arrive in one line or one pipe write and stay buffered until asked for
+struct InputReader
+{
+    int fd = 0;//descriptor to read
+    char buffer[1 << 16];//unread bytes live in [head, tail)
+    size_t head = 0;
+    size_t tail = 0;
+    bool eof = false;//read returned 0
+    ostream* tied = &cout;//flushed before every blocking read so prompts reach piped clients, as cin is tied to cout
+
+    //a token is waiting, whitespace left after the last one read does not count
+    bool buffered()
+    {
+        while (head < tail && isspace((unsigned char)buffer[head]))
+        {
+            head++;
+        }
+        return head < tail;
+    }
+
+    //read more bytes, moving unread ones to the front first, returns false at eof or with a full buffer
+    bool fill()
+    {
+        if (head > 0)
+        {
+            memmove(buffer, buffer + head, tail - head);
+            tail -= head;
+            head = 0;
+        }
+        if (tied)
+        {
+            tied->flush();
+        }
+        while (!eof && tail < sizeof(buffer))
+        {
+            ssize_t got = read(fd, buffer + tail, sizeof(buffer) - tail);
+            if (got > 0)
+            {
+                tail += got;
+                return true;
+            }
+            if (got == 0 || errno != EINTR)
+            {
+                eof = true;
+            }
+        }
+        return false;
+    }
+
+    //parse the next whitespace separated token as an int
+    InputStatus readInt(int& value)
+    {
+        while (true)
+        {
+            while (head < tail && isspace((unsigned char)buffer[head]))
+            {
+                head++;
+            }
+            if (head < tail) break;
+            if (!fill()) return INPUT_EOF;
+        }
+        size_t end = head;
+        while (true)
+        {
+            while (end < tail && !isspace((unsigned char)buffer[end]))
+            {
+                end++;
+            }
+            if (end < tail) break;
+            size_t length = end - head;
+            if (!fill()) break;//token runs to eof or fills the buffer
+            end = head + length;
+        }
+        const char* start = buffer + head;
+        if (*start == '+' && start + 1 < buffer + end && start[1] != '-')
+        {
+            start++;
+        }
+        auto result = from_chars(start, buffer + end, value);
+        bool ok = result.ec == errc() && result.ptr == buffer + end;
+        head = end;
+        return ok ? INPUT_OK : INPUT_BAD;
+    }
+
+    //block until a whole token is buffered, or eof or a full buffer, without consuming it
+    void awaitToken()
+    {
+        while (true)
+        {
+            size_t at = head;
+            while (at < tail && isspace((unsigned char)buffer[at]))
+            {
+                at++;
+            }
+            size_t start = at;
+            while (at < tail && !isspace((unsigned char)buffer[at]))
+            {
+                at++;
+            }
+            if ((at > start && at < tail) || !fill()) return;
+        }
+    }
+
+    //drop everything up to and including the next newline
+    void skipLine()
+    {
+        while (true)
+        {
+            char* newline = (char*)memchr(buffer + head, '\n', tail - head);
+            if (newline)
+            {
+                head = newline - buffer + 1;
+                return;
+            }
+            head = tail;
+            if (!fill()) return;
+        }
+    }
+};
+
+InputReader consoleInput;//stdin, read only by the interactive session
+
+//what one selection did to the session
+enum MoveResult
+{
+    MOVE_FLIPPED,//card turned up, the turn needs more picks
+    MOVE_MATCH,//last pick of the turn completed a match
+    MOVE_MISMATCH,//last pick of the turn, the cards differ
+    MOVE_INVALID,//first pick rejected, pick again
+    MOVE_FORFEIT,//later pick rejected, the turn is lost
+    MOVE_RESTART,//unreadable input, the turn starts over
+    MOVE_HINT,//hint given in lastHint
+    MOVE_NO_HINTS,//hint asked for with none left
+    MOVE_NO_HINT_FOUND,//no card qualifies for a hint
+    MOVE_UNDO,//this turn's picks or the last turn taken back
+    MOVE_NO_UNDO,//nothing left to undo
+    MOVE_REDO,//an undone turn played again
+    MOVE_NO_REDO,//nothing to redo
+    MOVE_QUIT//player left the board
+};
+
+//all mutable state of one game, sessions share nothing so many can run side by side
+struct GameSession
+{
+    Board board;//stores card values at (row, col)
+    int matchSize = 2;//cards flipped per turn, all must show the same value
+    int blankCells = 0;//filler cells left over when the board does not divide by matchSize
+    CellStates cellStates;//per-cell hidden/flipped/matched bitmap
+    int lastCell = -1;//last cell selected, it may not be selected again right away
+    int picked = 0;//cards flipped so far this turn
+    int turns = 0;//completed turns on this board
+    int hintsRemaining = 0;//hints remaining for current level
+    int hintsDealt = 0;//hints the board started with
+    pair<int, int> lastHint = {-1, -1};//card suggested by the last hint
+    MoveJournal journal;//completed turns for undo and redo
+    bool undone = false;//a completed turn was taken back, so this board's score cannot be a best
+    int totalMoves = 0;//total moves (card selections) in a level
+    CardPositions cardPositions;//cells holding each card value
+    HintEngine hintEngine;//unmatched pairs for hints
+    BoardRenderer renderer;//frame buffer for displayBoard
+    ScoreBST scoreTree;//bst instance for scores
+    ScoreStore* scoreStore = nullptr;//persistent scores, nullptr to keep them in memory only
+    string playerName = "player";//name the persistent scores are recorded under
+    FastRng rng;//draws the seed of every board dealt
+    uint64_t dealSeed = 0;//seed the current board was dealt from
+    FILE* replayFile = nullptr;//replay log sink, nullptr when not recording
+    vector<uint8_t> replayEvents;//encoded selections of the game being recorded
+    chrono::milliseconds revealDuration{1000};//how long a mismatch stays face up
+    chrono::steady_clock::time_point revealDeadline;//when the pending mismatch flips back
+    bool revealPending = false;//a mismatched pair is face up waiting for its deadline
+    vector<int> searchStamps;//visit stamps for adjacent hint searches
+    vector<int> searchFrontier;//cells waiting to be expanded
+    int searchStamp = 0;//current visit stamp
+};
+
+//aggregate results of headless games on one level
+struct LevelStats
+{
+    long long games = 0;//games attempted
+    long long failed = 0;//games where the player stalled
+    long long turnSum = 0;//turns over finished games
+    long long moveSum = 0;//card selections over finished games
+    double turnSquares = 0;//sum of squared turns for the deviation
+    int minTurns = numeric_limits<int>::max();//fewest turns seen
+    int maxTurns = 0;//most turns seen
+
+    //fold another worker's results into this one
+    void merge(const LevelStats& other)
+    {
+        games += other.games;
+        failed += other.failed;
+        turnSum += other.turnSum;
+        moveSum += other.moveSum;
+        turnSquares += other.turnSquares;
+        minTurns = min(minTurns, other.minTurns);
+        maxTurns = max(maxTurns, other.maxTurns);
+    }
+};
+
+//a run of consecutive games on one level
+struct GameBatch
+{
+    int level;//level to play
+    long long firstGame;//index of the first game, used to derive the seed
+    int count;//games in this batch
+};
+
+//per-worker batch queue, the owner pops from the back and thieves take from the front
+struct WorkQueue
+{
+    mutex lock;//guards batches
+    deque<GameBatch> batches;//pending work
+
+    bool popBack(GameBatch& batch)
+    {
+        lock_guard<mutex> guard(lock);
+        if (batches.empty()) return false;
+        batch = batches.back();
+        batches.pop_back();
+        return true;
+    }
+
+    bool stealFront(GameBatch& batch)
+    {
+        lock_guard<mutex> guard(lock);
+        if (batches.empty()) return false;
+        batch = batches.front();
+        batches.pop_front();
+        return true;
+    }
+};
+
+//reusable spinning barrier for threads that step through layers in lockstep
+struct SpinBarrier
+{
+    int parties;//threads that must arrive
+    atomic<int> arrived{0};//threads waiting in the current generation
+    atomic<int> generation{0};//bumped each time everyone has arrived
+
+    SpinBarrier(int count) : parties(count) {}
+
+    void wait()
+    {
+        int gen = generation.load(memory_order_acquire);
+        if (arrived.fetch_add(1, memory_order_acq_rel) + 1 == parties)
+        {
+            arrived.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+            return;
+        }
+        while (generation.load(memory_order_acquire) == gen)
+        {
+            this_thread::yield();
+        }
+    }
+};
+
+//scripted player for headless games
+class Player
+{
+public:
+    virtual ~Player() {}
+
+    //called once after the board is dealt
+    virtual void startGame(const GameSession& game) {}
+
+    //pick the next card to flip, must be a valid move
+    virtual pair<int, int> chooseCard(const GameSession& game) = 0;
+
+    //called after each flip with the value that was revealed
+    virtual void observe(const GameSession& game, int row, int col, int value) {}
+};
+
+//flips uniformly random hidden cards
+class RandomPlayer : public Player
+{
+private:
+    mt19937 rng;//player's own generator
+
+public:
+    RandomPlayer(unsigned seed) : rng(seed) {}
+
+    pair<int, int> chooseCard(const GameSession& game) override
+    {
+        uniform_int_distribution<int> pick(0, game.board.size() - 1);
+        int idx = pick(rng);
+        while (!game.cellStates.isHidden(idx) || idx == game.lastCell)
+        {
+            idx = pick(rng);
+        }
+        return {idx / game.board.cols, idx % game.board.cols};
+    }
+};
+
+//remembers up to capacity cells, evicting the least recently seen, and plays any fully known set first;
+//INT_MAX capacity is a perfect memory
+class MemoryPlayer : public Player
+{
+private:
+    int capacity;//cells remembered at once
+    int copies;//cards per match
+    vector<int> knownCells;//copies slots per value, cells remembered to hold it
+    vector<int> knownCount;//remembered cells per value
+    vector<int> complete;//values that had every copy remembered, checked again before use
+    vector<int> newer;//lru link towards the newest remembered cell, -1 at the end
+    vector<int> older;//lru link towards the oldest remembered cell, -1 at the end
+    vector<uint8_t> remembered;//cell is in memory
+    int newest;//most recently seen cell, -1 if memory is empty
+    int oldest;//least recently seen cell, -1 if memory is empty
+    int rememberedCount;//cells in memory
+    int nextUnseen;//cells below this have been flipped at least once
+    vector<int> forgotten;//flipped cells that fell out of memory
+    FastRng rng;//guesses among forgotten cells
+
+    //unlink a remembered cell from the lru list and its value's slots
+    void forget(int idx, int value)
+    {
+        (older[idx] == -1 ? oldest : newer[older[idx]]) = newer[idx];
+        (newer[idx] == -1 ? newest : older[newer[idx]]) = older[idx];
+        remembered[idx] = 0;
+        rememberedCount--;
+        int* slots = &knownCells[value * copies];
+        for (int n = 0; n < knownCount[value]; n++)
+        {
+            if (slots[n] == idx)
+            {
+                slots[n] = slots[--knownCount[value]];
+                break;
+            }
+        }
+    }
+
+    //move a cell to the newest end of the lru list, remembering it if needed
+    void touch(const GameSession& game, int idx, int value)
+    {
+        if (remembered[idx])
+        {
+            if (newest == idx) return;
+            forget(idx, value);
+        }
+        remembered[idx] = 1;
+        rememberedCount++;
+        older[idx] = newest;
+        newer[idx] = -1;
+        (newest == -1 ? oldest : newer[newest]) = idx;
+        newest = idx;
+        knownCells[value * copies + knownCount[value]++] = idx;
+        if (knownCount[value] == copies)
+        {
+            complete.push_back(value);
+        }
+        if (rememberedCount > capacity)
+        {
+            int victim = oldest;
+            forget(victim, game.board.cells[victim]);
+            forgotten.push_back(victim);
+        }
+    }
+
+    //a hidden cell the player cannot place: a never flipped one, else a random forgotten one,
+    //else any hidden cell once every one is known
+    int takeUnknown(const GameSession& game)
+    {
+        while (nextUnseen < game.board.size())
+        {
+            int idx = scanKernels.firstHidden(game.cellStates.flippedBits.data(), game.cellStates.matchedBits.data(),
+                                              game.board.size(), nextUnseen);
+            if (idx < 0)
+            {
+                nextUnseen = game.board.size();
+                break;
+            }
+            nextUnseen = idx + 1;
+            if (!remembered[idx]) return idx;
+        }
+        while (!forgotten.empty())
+        {
+            int pick = rng.below(forgotten.size());
+            int idx = forgotten[pick];
+            forgotten[pick] = forgotten.back();
+            forgotten.pop_back();
+            if (game.cellStates.isHidden(idx) && !remembered[idx]) return idx;
+        }
+        for (int idx = oldest; idx != -1; idx = newer[idx])
+        {
+            if (game.cellStates.isHidden(idx) && idx != game.lastCell) return idx;
+        }
+        return -1;
+    }
+
+    //a remembered hidden cell holding value, -1 if none
+    int knownHidden(const GameSession& game, int value) const
+    {
+        const int* slots = &knownCells[value * copies];
+        for (int n = 0; n < knownCount[value]; n++)
+        {
+            if (game.cellStates.isHidden(slots[n]) && slots[n] != game.lastCell) return slots[n];
+        }
+        return -1;
+    }
+
+public:
+    MemoryPlayer(int cells = numeric_limits<int>::max(), unsigned seed = 0) : capacity(max(1, cells))
+    {
+        rng.seed(seed);
+    }
+
+    void startGame(const GameSession& game) override
+    {
+        int cellCount = game.board.size();
+        int values = game.cardPositions.cells.size() / game.cardPositions.copies;
+        copies = game.matchSize;
+        knownCells.assign((values + 1) * copies, -1);
+        knownCount.assign(values + 1, 0);
+        complete.clear();
+        complete.reserve(values);
+        newer.assign(cellCount, -1);
+        older.assign(cellCount, -1);
+        remembered.assign(cellCount, 0);
+        newest = -1;
+        oldest = -1;
+        rememberedCount = 0;
+        nextUnseen = 0;
+        forgotten.clear();
+    }
+
+    pair<int, int> chooseCard(const GameSession& game) override
+    {
+        const vector<int>& up = game.cellStates.flippedCells;
+        int idx = -1;
+        if (up.empty())
+        {
+            while (idx == -1 && !complete.empty())
+            {
+                int value = complete.back();
+                complete.pop_back();
+                if (knownCount[value] == copies)
+                {
+                    idx = knownHidden(game, value);
+                }
+            }
+        }
+        else
+        {
+            //keep a turn alive with remembered copies of its value
+            int value = game.board.cells[up[0]];
+            bool alive = true;
+            for (int cell : up)
+            {
+                alive = alive && game.board.cells[cell] == value;
+            }
+            if (alive)
+            {
+                idx = knownHidden(game, value);
+            }
+        }
+        if (idx == -1)
+        {
+            idx = takeUnknown(game);
+        }
+        return {idx / game.board.cols, idx % game.board.cols};
+    }
+
+    void observe(const GameSession& game, int row, int col, int value) override
+    {
+        touch(game, game.board.index(row, col), value);
+        const vector<int>& up = game.cellStates.flippedCells;
+        if ((int)up.size() != copies) return;
+        for (int cell : up)
+        {
+            if (game.board.cells[cell] != value) return;
+        }
+        for (int cell : up)
+        {
+            if (remembered[cell])
+            {
+                forget(cell, value);//matched cells leave memory, earlier picks may already be evicted below matchSize cells
+            }
+        }
+    }
+};
+
+//reads cardPositions and matches one value per turn, a lower bound for every other model
+class OraclePlayer : public Player
+{
+public:
+    pair<int, int> chooseCard(const GameSession& game) override
+    {
+        const vector<int>& up = game.cellStates.flippedCells;
+        int value = up.empty() ? game.hintEngine.anyUnmatched() : game.board.cells[up[0]];
+        for (int n = 0; n < game.cardPositions.copies; n++)
+        {
+            int idx = game.cardPositions.at(value, n);
+            if (game.cellStates.isHidden(idx) && idx != game.lastCell)
+            {
+                return {idx / game.board.cols, idx % game.board.cols};
+            }
+        }
+        return {-1, -1};
+    }
+};
+
+//per-phase latency histograms, compiled in with -DMEMORY_MATCH_PROFILE
+#ifdef MEMORY_MATCH_PROFILE
+enum ProfilePhase
+{
+    PHASE_INPUT,
+    PHASE_VALIDATE,
+    PHASE_RENDER,
+    PHASE_MATCH,
+    PHASE_HINT,
+    PHASE_COUNT
+};
+
+const char* const phaseNames[PHASE_COUNT] = {"input", "validate", "render", "match", "hint"};
+
+//log2 buckets of nanoseconds, updated with relaxed atomics so any thread can record
+struct LatencyHistogram
+{
+    static const int BUCKETS = 40;//bucket b holds samples in [2^(b-1), 2^b) ns
+    atomic<uint64_t> buckets[BUCKETS] = {};
+    atomic<uint64_t> count{0};
+    atomic<uint64_t> totalNs{0};
+    atomic<uint64_t> maxNs{0};
+
+    void record(uint64_t ns)
+    {
+        int bucket = ns ? min(64 - __builtin_clzll(ns), BUCKETS - 1) : 0;
+        buckets[bucket].fetch_add(1, memory_order_relaxed);
+        count.fetch_add(1, memory_order_relaxed);
+        totalNs.fetch_add(ns, memory_order_relaxed);
+        uint64_t seen = maxNs.load(memory_order_relaxed);
+        while (ns > seen && !maxNs.compare_exchange_weak(seen, ns, memory_order_relaxed))
+        {
+        }
+    }
+
+    //upper bound of the bucket holding the given fraction of samples
+    uint64_t percentile(double fraction) const
+    {
+        uint64_t target = uint64_t(fraction * count.load(memory_order_relaxed));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++)
+        {
+            seen += buckets[b].load(memory_order_relaxed);
+            if (seen > target) return b ? uint64_t(1) << b : 1;
+        }
+        return maxNs.load(memory_order_relaxed);
+    }
+};
+
+LatencyHistogram phaseHistograms[PHASE_COUNT];//process-wide, shared by every session
+
+//records the lifetime of a scope into one phase's histogram
+struct PhaseTimer
+{
+    ProfilePhase phase;
+    chrono::steady_clock::time_point start;
+
+    PhaseTimer(ProfilePhase p) : phase(p), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer()
+    {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        phaseHistograms[phase].record(ns);
+    }
+};
+
+//print every phase that has samples
+void dumpProfile(ostream& out)
+{
+    out << "Phase Latency (ns):\n";
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        const LatencyHistogram& h = phaseHistograms[p];
+        uint64_t n = h.count.load(memory_order_relaxed);
+        if (!n) continue;
+        out << phaseNames[p] << ": count " << n << ", mean " << h.totalNs.load(memory_order_relaxed) / n
+            << ", p50 <" << h.percentile(0.5) << ", p99 <" << h.percentile(0.99)
+            << ", max " << h.maxNs.load(memory_order_relaxed) << "\n";
+    }
+}
+
+void dumpProfileAtExit()
+{
+    dumpProfile(cerr);
+}
+
+#define PROFILE_PHASE(phase) PhaseTimer phaseTimer(phase)
+#else
+#define PROFILE_PHASE(phase)
+#endif
+
+//function declarations
+void displayWithBorder(const string& text);
+void appendBordered(string& out, const string& text);
+string turnPrompt(GameSession& game);
+string resultMessage(GameSession& game, MoveResult result);
+void appendMenu(string& out, GameSession& game);
+void initializeGame(GameSession& game, int level);
+void initializeBoard(GameSession& game, int rows, int cols, int copies, int hints, uint64_t seed);
+void dealBoard(GameSession& game, int values, int copies);
+FrameBuilder levelFrameBuilder(int level);
+void displayBoard(GameSession& game);
+void writeGlyph(char* at, int value, int width);
+const string& renderBoard(GameSession& game);
+bool checkMatch(GameSession& game);
+bool isValidMove(GameSession& game, int row, int col, bool checkPrevious = false);
+bool playTurn(GameSession& game);
+int countMatches(GameSession& game);
+void showMenu(GameSession& game);
+void updateScore(GameSession& game, int level, int turns);
+void getHint(GameSession& game, MoveResult result);
+void displayNotice(GameSession& game, const string& message);
+MoveResult requestHint(GameSession& game);
+MoveResult applyInput(GameSession& game, int row, int col);
+MoveResult restartTurn(GameSession& game);
+MoveResult undoTurn(GameSession& game);
+MoveResult redoTurn(GameSession& game);
+void appendVarint(vector<uint8_t>& out, uint64_t value);
+bool readVarint(const uint8_t*& at, const uint8_t* end, uint64_t& value);
+void logEvent(GameSession& game, uint64_t event);
+void saveReplay(GameSession& game);
+void runReplay(const string& path);
+pair<int, int> findHint(GameSession& game);
+void displayStats(GameSession& game, int turns);
+void flipCard(GameSession& game, int row, int col);
+void undoPicks(GameSession& game, int count);
+int playBoard(GameSession& game, const string& background);
+void clearLevel(GameSession& game);
+void runCustomGame(GameSession& game, int rows, int cols, int copies);
+void resolveTurn(GameSession& game, bool match);
+void scheduleReveal(GameSession& game);
+bool tickReveal(GameSession& game, chrono::steady_clock::time_point now);
+void finishReveal(GameSession& game);
+bool awaitInput(GameSession& game);
+int playHeadlessGame(GameSession& game, int level, Player& player);
+unique_ptr<Player> makePlayer(const string& name, unsigned seed);
+void runSimulation(int gamesPerLevel, const string& playerNames, unsigned masterSeed, int threadCount, const vector<int>& bests);
+void simulatePlayer(int gamesPerLevel, const string& playerName, unsigned masterSeed, int threadCount, const vector<int>& bests);
+void playLevel1(GameSession& game);
+void playLevel2(GameSession& game);
+void playLevel3(GameSession& game);
+void playLevel4(GameSession& game);
+void playLevel5(GameSession& game);
+void playLevel6(GameSession& game);
+void playLevel7(GameSession& game);
+void playLevel8(GameSession& game);
+pair<int, int> findMatchAdjacent(GameSession& game, int value, int row, int col);
+pair<int, int> partnerOf(GameSession& game, int row, int col);
+void mergeSort(vector<int>& arr, int left, int right);
+void runSortBenchmark(long long maxSize);
+void runBenchmarks();
+double expectedTurns(long long pairs, int threadCount, long long* wasteStates = nullptr);
+double asymptoticTurns(long long pairs);
+double levelPar(int level);
+void runParTable(int gamesPerBoard, unsigned masterSeed, int threadCount);
+#ifdef __linux__
+struct Reactor;
+struct ClientSession;
+void raiseFileLimit();
+int openListener(int port);
+int connectLocal(int port);
+void appendTurnView(string& out, GameSession& game);
+void handleClientLine(Reactor& reactor, ClientSession& client, char* line);
+size_t handleClientBinary(Reactor& reactor, ClientSession& client, size_t start);
+void appendMessage(ClientSession& client);
+void appendDelta(vector<uint8_t>& out, GameSession& game, int cell, int state);
+void flushClient(Reactor& reactor, ClientSession& client);
+void serveInput(Reactor& reactor, ClientSession& client);
+void closeClient(Reactor& reactor, int fd);
+void runReactor(int port, unsigned masterSeed, int id);
+void runServer(int port, unsigned masterSeed, int threadCount);
+bool endsWithPrompt(const string& text);
+void runIdleTest(int port, int idleClients, int probeMoves);
+int frameValue(const string& reply, const Board& board, int values, int idx);
+void runLoadTest(int port, int players, int level, int gamesPerPlayer, int threadCount, bool startServer, bool binary,
+                 unsigned masterSeed);
+#endif
+
+//display text with a bordered format
+void displayWithBorder(const string& text)
+{
+    string framed;
+    appendBordered(framed, text);
+    cout << framed;
+}
+
+//append text with a bordered format
+void appendBordered(string& out, const string& text)
+{
+    int width = text.length() + 4;//calculate border width
+    out.append(width, '-');
+    out.append("\n| ");
+    out.append(text);
+    out.append(" |\n");
+    out.append(width, '-');
+    out.push_back('\n');
+}
+
+//insertion sort for short runs
+template <typename T, typename Compare>
+void insertionSort(T* data, size_t n, Compare less)
+{
+    for (size_t i = 1; i < n; i++)
+    {
+        T value = data[i];
+        size_t j = i;
+        while (j > 0 && less(value, data[j - 1]))
+        {
+            data[j] = data[j - 1];
+            j--;
+        }
+        data[j] = value;
+    }
+}
+
+//stable merge sort of data[0, n) using scratch[0, n) as the only buffer,
+//the top parallelDepth levels sort their halves on separate threads
+template <typename T, typename Compare>
+void mergeSortKernel(T* data, T* scratch, size_t n, Compare less, int parallelDepth)
+{
+    const size_t insertionCutoff = 32;//short runs sort faster by insertion
+    const size_t parallelCutoff = 1 << 16;//smaller runs are not worth a thread
+    if (n <= insertionCutoff)
+    {
+        insertionSort(data, n, less);
+        return;
+    }
+    size_t mid = n / 2;
+    if (parallelDepth > 0 && n >= parallelCutoff)
+    {
+        //each half sorts with the matching half of scratch so the threads never share it
+        thread leftWorker([=] { mergeSortKernel(data, scratch, mid, less, parallelDepth - 1); });
+        mergeSortKernel(data + mid, scratch + mid, n - mid, less, parallelDepth - 1);
+        leftWorker.join();
+    }
+    else
+    {
+        mergeSortKernel(data, scratch, mid, less, 0);
+        mergeSortKernel(data + mid, scratch, n - mid, less, 0);
+    }
+    if (!less(data[mid], data[mid - 1])) return;//halves already in order
+    //move the left half out, then merge it with the right half back into data
+    copy(data, data + mid, scratch);
+    size_t i = 0;
+    size_t j = mid;
+    size_t k = 0;
+    while (i < mid && j < n)
+    {
+        if (less(data[j], scratch[i]))
+        {
+            data[k++] = data[j++];
+        }
+        else
+        {
+            data[k++] = scratch[i++];
+        }
+    }
+    while (i < mid)
+    {
+        data[k++] = scratch[i++];
+    }
+}
+
+//merge sort arr[left, right] in place, parallel across the available cores
+void mergeSort(vector<int>& arr, int left, int right)
+{
+    if (left >= right) return;
+    size_t n = right - left + 1;
+    vector<int> scratch(n);
+    static const int depth = []
+    {
+        int levels = 0;
+        for (unsigned cores = thread::hardware_concurrency(); cores > 1; cores = (cores + 1) / 2)
+        {
+            levels++;
+        }
+        return levels;
+    }();
+    mergeSortKernel(arr.data() + left, scratch.data(), n, less<int>(), depth);
+}
+
+//time mergeSort against std::sort and std::stable_sort on random ints up to maxSize elements
+void runSortBenchmark(long long maxSize)
+{
+    cout << "n,merge_sort_ms,std_sort_ms,std_stable_sort_ms\n";
+    FastRng rng;
+    rng.seed(12345);
+    for (long long n = 1000; n <= maxSize; n *= 10)
+    {
+        vector<int> source(n);
+        for (auto& value : source)
+        {
+            value = int(rng.next() >> 33);
+        }
+        vector<int> work;
+        auto timeIt = [&](auto sorter)
+        {
+            work = source;
+            auto start = chrono::steady_clock::now();
+            sorter(work);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            if (!is_sorted(work.begin(), work.end()))
+            {
+                cout << "# unsorted output at n=" << n << "\n";
+            }
+            return ms;
+        };
+        double mergeMs = timeIt([](vector<int>& v) { mergeSort(v, 0, v.size() - 1); });
+        double sortMs = timeIt([](vector<int>& v) { sort(v.begin(), v.end()); });
+        double stableMs = timeIt([](vector<int>& v) { stable_sort(v.begin(), v.end()); });
+        cout << n << "," << mergeMs << "," << sortMs << "," << stableMs << "\n";
+    }
+}
+
+//deal copies of each value 1..values into the board, blank the rest, and shuffle in place
+void dealBoard(GameSession& game, int values, int copies)
+{
+    vector<int>& deck = game.board.cells;
+    int cards = values * copies;
+    for (int i = 0; i < cards; i++)
+    {
+        deck[i] = i / copies + 1;
+    }
+    fill(deck.begin() + cards, deck.end(), 0);//blank filler
+    FastRng dealer;//private stream so a logged seed reproduces the deal
+    dealer.seed(game.dealSeed);
+    for (int i = deck.size() - 1; i > 0; i--)
+    {
+        swap(deck[i], deck[dealer.below(i + 1)]);//fisher-yates
+    }
+    game.cardPositions.reset(values, copies);
+    for (int i = 0; i < (int)deck.size(); i++)
+    {
+        if (deck[i])
+        {
+            game.cardPositions.add(deck[i], i);
+        }
+    }
+}
+
+//set up a rows x cols board where every value appears copies times, dealt from seed
+void initializeBoard(GameSession& game, int rows, int cols, int copies, int hints, uint64_t seed)
+{
+    game.dealSeed = seed;
+    game.hintsRemaining = hints;
+    game.hintsDealt = hints;
+    game.matchSize = copies;
+    game.board.resize(rows, cols);
+    int values = game.board.size() / copies;
+    game.blankCells = game.board.size() - values * copies;
+    dealBoard(game, values, copies);
+    game.hintEngine.reset(values);
+    game.cellStates.reset(game.board.size());
+    game.cellStates.flippedCells.reserve(copies);
+    if (game.blankCells)
+    {
+        for (int i = 0; i < game.board.size(); i++)
+        {
+            if (!game.board.cells[i])
+            {
+                game.cellStates.markMatched(i);
+            }
+        }
+    }
+    game.lastCell = -1;
+    game.picked = 0;
+    game.turns = 0;
+    game.totalMoves = 0;
+    game.journal.reset(copies);
+    game.undone = false;
+    game.replayEvents.clear();
+    game.renderer.fixed = nullptr;
+}
+
+//initialize game board
+void initializeGame(GameSession& game, int level)
+{
+    initializeBoard(game, 2 * level, 2 * level, 2, level, game.rng.next());//square board of pairs, one hint per level
+    game.renderer.fixed = levelFrameBuilder(level);
+}
+
+//append an integer to a frame without going through a stream
+void appendInt(string& out, int value)
+{
+    char digits[16];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+//append an integer right-aligned in width columns
+void appendPadded(string& out, int value, int width)
+{
+    char digits[16];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    int length = result.ptr - digits;
+    if (length < width)
+    {
+        out.append(width - length, ' ');
+    }
+    out.append(digits, result.ptr);
+}
+
+//write what a cell shows in width columns: a right-aligned value, '-' for hidden (0) or blanks for filler (-1)
+void writeGlyph(char* at, int value, int width)
+{
+    if (value <= 0)
+    {
+        memset(at, ' ', width);
+        at[width - 1] = value ? ' ' : '-';
+    }
+    else
+    {
+        for (int n = width - 1; n >= 0; n--)
+        {
+            at[n] = value ? char('0' + value % 10) : ' ';
+            value /= 10;
+        }
+    }
+    at[width] = ' ';
+}
+
+//number of decimal digits in a positive value
+int digitCount(int value)
+{
+    int count = 1;
+    while (value >= 10)
+    {
+        value /= 10;
+        count++;
+    }
+    return count;
+}
+
+//number of decimal digits in a positive value, for layouts known at compile time
+constexpr int decimalDigits(int value)
+{
+    return value < 10 ? 1 : 1 + decimalDigits(value / 10);
+}
+
+//engine for a built-in level's N x N board of pairs, every layout width and offset is a compile-time
+//constant so a classic frame is a copy of a prebuilt all-hidden frame with the face-up cells patched in
+template <int N>
+struct LevelBoard
+{
+    static constexpr int CELLS = N * N;
+    static constexpr int WORDS = (CELLS + 63) / 64;//words of a cell bit mask
+    static constexpr int LABEL_WIDTH = decimalDigits(N);
+    static constexpr int CELL_WIDTH = max(decimalDigits(CELLS / 2), decimalDigits(N));
+    static constexpr int RULE = N * (CELL_WIDTH + 1) + 1;//underscores or dashes above and below the cells
+    static constexpr int HEADER = LABEL_WIDTH + 4 + N * (CELL_WIDTH + 1) + 1 + LABEL_WIDTH + 3 + RULE + 1;
+    static constexpr int ROW = LABEL_WIDTH + 4 + N * (CELL_WIDTH + 1) + 2;
+    static constexpr int FRAME = HEADER + N * ROW + LABEL_WIDTH + 3 + RULE + 1;
+
+    //the frame of a board with every card face down, built on first use
+    static const array<char, FRAME>& hiddenFrame()
+    {
+        static const array<char, FRAME> frame = []
+        {
+            string out;
+            out.append(LABEL_WIDTH + 4, ' ');
+            for (int j = 0; j < N; j++)
+            {
+                appendPadded(out, j + 1, CELL_WIDTH);
+                out.push_back(' ');
+            }
+            out.push_back('\n');
+            out.append(LABEL_WIDTH + 3, ' ');
+            out.append(RULE, '_');
+            out.push_back('\n');
+            for (int i = 0; i < N; i++)
+            {
+                appendPadded(out, i + 1, LABEL_WIDTH);
+                out.append("   |");
+                for (int j = 0; j < N; j++)
+                {
+                    out.append(CELL_WIDTH - 1, ' ');
+                    out.append("- ");
+                }
+                out.append("|\n");
+            }
+            out.append(LABEL_WIDTH + 3, ' ');
+            out.append(RULE, '-');
+            out.push_back('\n');
+            array<char, FRAME> built;
+            copy(out.begin(), out.end(), built.begin());
+            return built;
+        }();
+        return frame;
+    }
+
+    //right-align a card value in its column, blank filler is 0
+    static void writeCell(char* at, int value)
+    {
+        for (int n = CELL_WIDTH - 1; n >= 0; n--)
+        {
+            at[n] = value ? char('0' + value % 10) : ' ';
+            value /= 10;
+        }
+    }
+
+    //classic frame in o(face-up cells) after one copy
+    static const string& render(GameSession& game)
+    {
+        const array<char, FRAME>& hidden = hiddenFrame();
+        string& out = game.renderer.frame;
+        out.assign(hidden.data(), FRAME);
+        array<uint64_t, WORDS> shown;//face-up and matched cells
+        for (int w = 0; w < WORDS; w++)
+        {
+            shown[w] = game.cellStates.flippedBits[w] | game.cellStates.matchedBits[w];
+        }
+        const int* cells = game.board.cells.data();
+        for (int w = 0; w < WORDS; w++)
+        {
+            for (uint64_t bits = shown[w]; bits; bits &= bits - 1)
+            {
+                int idx = w * 64 + __builtin_ctzll(bits);
+                writeCell(&out[HEADER + idx / N * ROW + LABEL_WIDTH + 4 + idx % N * (CELL_WIDTH + 1)], cells[idx]);
+            }
+        }
+        return out;
+    }
+};
+
+//specialised engine for a built-in level, null for levels past MAX_LEVELS which use the runtime-sized path
+FrameBuilder levelFrameBuilder(int level)
+{
+    switch (level)
+    {
+        case 1:
+            return LevelBoard<2>::render;
+        case 2:
+            return LevelBoard<4>::render;
+        case 3:
+            return LevelBoard<6>::render;
+        case 4:
+            return LevelBoard<8>::render;
+        case 5:
+            return LevelBoard<10>::render;
+        case 6:
+            return LevelBoard<12>::render;
+        case 7:
+            return LevelBoard<14>::render;
+        case 8:
+            return LevelBoard<16>::render;
+        default:
+            return nullptr;
+    }
+}
+
+//build the next board frame in the session's buffer
+const string& renderBoard(GameSession& game)
+{
+    BoardRenderer& view = game.renderer;
+    if (view.fixed && !view.ansi)
+    {
+        return view.fixed(game);
+    }
+    const Board& board = game.board;
+    string& out = view.frame;
+    out.clear();
+    int labelWidth = digitCount(board.rows);
+    int cellWidth = max(digitCount(game.cardPositions.cells.size() / game.cardPositions.copies), digitCount(board.cols));
+    if (!view.ansi)
+    {
+        out.append(labelWidth + 4, ' ');
+        for (int j = 0; j < board.cols; j++)
+        {
+            appendPadded(out, j + 1, cellWidth);
+            out.push_back(' ');
+        }
+        out.push_back('\n');
+        out.append(labelWidth + 3, ' ');
+        out.append(board.cols * (cellWidth + 1) + 1, '_');
+        out.push_back('\n');
+        view.row.resize(board.cols);
+        for (int i = 0; i < board.rows; i++)
+        {
+            appendPadded(out, i + 1, labelWidth);
+            out.append("   |");
+            scanKernels.visibleRow(board.cells.data(), game.cellStates.flippedBits.data(), game.cellStates.matchedBits.data(),
+                                   board.index(i, 0), board.cols, view.row.data());
+            size_t at = out.size();
+            out.resize(at + board.cols * (cellWidth + 1));
+            for (int j = 0; j < board.cols; j++, at += cellWidth + 1)
+            {
+                writeGlyph(&out[at], view.row[j], cellWidth);
+            }
+            out.append("|\n");
+        }
+        out.append(labelWidth + 3, ' ');
+        out.append(board.cols * (cellWidth + 1) + 1, '-');
+        out.push_back('\n');
+        return out;
+    }
+    //ansi mode keeps every cell at a known screen position
+    int topRow = view.bannerLines + 1;
+    int bottomRow = topRow + board.rows + 3;
+    if (!view.drawn || (int)view.shown.size() != board.size())
+    {
+        view.shown.assign(board.size(), 0);
+        out.append("\x1b[H\x1b[2J");
+        out.append(view.banner);
+        out.append(labelWidth + 2, ' ');
+        for (int j = 0; j < board.cols; j++)
+        {
+            appendPadded(out, j + 1, cellWidth);
+            out.push_back(' ');
+        }
+        out.push_back('\n');
+        out.append(labelWidth + 1, ' ');
+        out.append(board.cols * (cellWidth + 1) + 1, '_');
+        out.push_back('\n');
+        for (int i = 0; i < board.rows; i++)
+        {
+            appendPadded(out, i + 1, labelWidth);
+            out.append(" |");
+            for (int j = 0; j < board.cols; j++)
+            {
+                out.append(cellWidth - 1, ' ');
+                out.append("- ");
+            }
+            out.append("|\n");
+        }
+        out.append(labelWidth + 1, ' ');
+        out.append(board.cols * (cellWidth + 1) + 1, '-');
+        out.push_back('\n');
+        view.drawn = true;
+    }
+    view.row.resize(board.cols);
+    for (int idx = 0; idx < board.size(); idx++)
+    {
+        if (idx % board.cols == 0)
+        {
+            //hidden cells are 0, blank filler is -1, rows that did not change are skipped whole
+            scanKernels.visibleRow(board.cells.data(), game.cellStates.flippedBits.data(), game.cellStates.matchedBits.data(),
+                                   idx, board.cols, view.row.data());
+            if (memcmp(view.row.data(), &view.shown[idx], board.cols * sizeof(int)) == 0)
+            {
+                idx += board.cols - 1;
+                continue;
+            }
+        }
+        int value = view.row[idx % board.cols];
+        if (value == view.shown[idx]) continue;
+        view.shown[idx] = value;
+        out.append("\x1b[");
+        appendInt(out, topRow + 2 + idx / board.cols);
+        out.push_back(';');
+        appendInt(out, labelWidth + 3 + (idx % board.cols) * (cellWidth + 1));
+        out.push_back('H');
+        if (value > 0)
+        {
+            appendPadded(out, value, cellWidth);
+        }
+        else if (value == 0)
+        {
+            out.append(cellWidth - 1, ' ');
+            out.push_back('-');
+        }
+        else
+        {
+            out.append(cellWidth, ' ');
+        }
+    }
+    //park the cursor under the board and clear old prompts
+    out.append("\x1b[");
+    appendInt(out, bottomRow);
+    out.append(";1H\x1b[J");
+    return out;
+}
+
+//display the game board with a single write
+void displayBoard(GameSession& game)
+{
+    PROFILE_PHASE(PHASE_RENDER);
+    const string& frame = renderBoard(game);
+    cout.write(frame.data(), frame.size());
+    cout.flush();
+}
+
+//check if flipped cards match
+bool checkMatch(GameSession& game)
+{
+    PROFILE_PHASE(PHASE_MATCH);
+    const vector<int>& up = game.cellStates.flippedCells;
+    if ((int)up.size() != game.matchSize) return false;
+    int value = game.board.cells[up[0]];
+    for (size_t n = 1; n < up.size(); n++)
+    {
+        if (game.board.cells[up[n]] != value) return false;
+    }
+    return true;
+}
+
+//validate a move
+bool isValidMove(GameSession& game, int row, int col, bool checkPrevious)
+{
+    bool validBounds = row >= 0 && row < game.board.rows &&
+                       col >= 0 && col < game.board.cols &&
+                       game.cellStates.isHidden(game.board.index(row, col));
+    if (!validBounds) return false;
+    return !checkPrevious || game.board.index(row, col) != game.lastCell;
+}
+
+//find a hidden card with the same value, o(copies) through cardPositions
+pair<int, int> partnerOf(GameSession& game, int row, int col)
+{
+    int self = game.board.index(row, col);
+    int value = game.board.cells[self];
+    for (int n = 0; n < game.cardPositions.copies; n++)
+    {
+        int idx = game.cardPositions.at(value, n);
+        if (idx != self && game.cellStates.isHidden(idx))
+        {
+            return {idx / game.board.cols, idx % game.board.cols};
+        }
+    }
+    return {-1, -1};
+}
+
+//breadth-first search from (row, col) through hidden cells for the card matching value
+pair<int, int> findMatchAdjacent(GameSession& game, int value, int row, int col)
+{
+    vector<int>& visited = game.searchStamps;
+    vector<int>& frontier = game.searchFrontier;
+    if (visited.size() != game.board.cells.size())
+    {
+        visited.assign(game.board.cells.size(), 0);
+        game.searchStamp = 0;
+    }
+    int stamp = ++game.searchStamp;
+    frontier.clear();
+    int start = game.board.index(row, col);
+    visited[start] = stamp;
+    frontier.push_back(start);
+    const int dr[] = {-1, 1, 0, 0};
+    const int dc[] = {0, 0, -1, 1};
+    for (size_t head = 0; head < frontier.size(); head++)
+    {
+        int r = frontier[head] / game.board.cols;
+        int c = frontier[head] % game.board.cols;
+        for (int d = 0; d < 4; d++)
+        {
+            int newRow = r + dr[d];
+            int newCol = c + dc[d];
+            if (!isValidMove(game, newRow, newCol, false)) continue;
+            int idx = game.board.index(newRow, newCol);
+            if (visited[idx] == stamp) continue;
+            visited[idx] = stamp;
+            if (game.board.cells[idx] == value)
+            {
+                return {newRow, newCol};
+            }
+            frontier.push_back(idx);
+        }
+    }
+    return {-1, -1};
+}
+
+//flip a card face up and record the move
+void flipCard(GameSession& game, int row, int col)
+{
+    game.lastCell = game.board.index(row, col);
+    game.cellStates.flip(game.lastCell);
+    game.totalMoves++;
+}
+
+//turn the last count cards of this turn face down again
+void undoPicks(GameSession& game, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        game.cellStates.unflipLast();
+        game.totalMoves--;
+    }
+}
+
+//settle the face up cards as the turn's checkMatch found them
+void resolveTurn(GameSession& game, bool match)
+{
+    if (match)
+    {
+        game.hintEngine.onMatched(game.board.cells[game.cellStates.flippedCells[0]]);
+        game.cellStates.matchFlipped();
+    }
+    else
+    {
+        game.cellStates.clearFlipped();
+    }
+}
+
+//leave a mismatched pair face up until the reveal duration has passed
+void scheduleReveal(GameSession& game)
+{
+    game.revealPending = true;
+    game.revealDeadline = chrono::steady_clock::now() + game.revealDuration;
+}
+
+//flip a pending mismatch back once its deadline has passed, returns true if it did
+bool tickReveal(GameSession& game, chrono::steady_clock::time_point now)
+{
+    if (!game.revealPending || now < game.revealDeadline) return false;
+    finishReveal(game);
+    return true;
+}
+
+//flip a pending mismatch back right away
+void finishReveal(GameSession& game)
+{
+    if (!game.revealPending) return;
+    game.revealPending = false;
+    resolveTurn(game, false);//only mismatches wait for a reveal
+}
+
+//wait for console input while running the reveal timer, returns false if the board was redrawn
+bool awaitInput(GameSession& game)
+{
+    while (game.revealPending)
+    {
+        if (consoleInput.buffered()) return true;
+        auto remaining = chrono::duration_cast<chrono::milliseconds>(game.revealDeadline - chrono::steady_clock::now());
+        cout.flush();//the prompt must be out before waiting on the player
+        pollfd console = {0, POLLIN, 0};
+        if (remaining.count() > 0 && poll(&console, 1, remaining.count()) > 0) return true;
+        if (tickReveal(game, chrono::steady_clock::now()))
+        {
+            displayBoard(game);
+            return false;
+        }
+    }
+    return true;
+}
+
+//feed one console selection to the session, row and col are as typed (1-based, -1 -1 hint, -9 -9 quit)
+MoveResult applyInput(GameSession& game, int row, int col)
+{
+    finishReveal(game);
+    if (row == -9 && col == -9)
+    {
+        logEvent(game, REPLAY_QUIT);
+        undoPicks(game, game.picked);
+        game.picked = 0;
+        return MOVE_QUIT;
+    }
+    if (row == -1 && col == -1)
+    {
+        logEvent(game, REPLAY_HINT);
+        return requestHint(game);
+    }
+    if (row == -2 && col == -2)
+    {
+        logEvent(game, REPLAY_UNDO);
+        return undoTurn(game);
+    }
+    if (row == -3 && col == -3)
+    {
+        logEvent(game, REPLAY_REDO);
+        return redoTurn(game);
+    }
+    row--;
+    col--;
+    bool onBoard = row >= 0 && row < game.board.rows && col >= 0 && col < game.board.cols;
+    logEvent(game, onBoard ? REPLAY_CELL + game.board.index(row, col) : REPLAY_OFF_BOARD);
+    bool valid;
+    {
+        PROFILE_PHASE(PHASE_VALIDATE);
+        valid = isValidMove(game, row, col, true);
+    }
+    if (!valid)
+    {
+        if (game.picked == 0) return MOVE_INVALID;
+        undoPicks(game, game.picked);//a bad later pick forfeits the turn
+        game.picked = 0;
+        return MOVE_FORFEIT;
+    }
+    flipCard(game, row, col);
+    if (++game.picked < game.matchSize) return MOVE_FLIPPED;
+    game.picked = 0;
+    game.turns++;
+    bool match = checkMatch(game);
+    game.journal.record(game.cellStates.flippedCells, match);
+    if (match)
+    {
+        resolveTurn(game, true);
+        return MOVE_MATCH;
+    }
+    scheduleReveal(game);
+    return MOVE_MISMATCH;
+}
+
+//throw away this turn's picks after unreadable input
+MoveResult restartTurn(GameSession& game)
+{
+    finishReveal(game);
+    logEvent(game, REPLAY_RESTART);
+    undoPicks(game, game.picked);
+    game.picked = 0;
+    return MOVE_RESTART;
+}
+
+//take back this turn's picks, or the last completed turn if none are up, in o(matchSize)
+MoveResult undoTurn(GameSession& game)
+{
+    if (game.picked > 0)
+    {
+        undoPicks(game, game.picked);
+        game.picked = 0;
+        return MOVE_UNDO;
+    }
+    MoveJournal& journal = game.journal;
+    if (journal.undoable == 0) return MOVE_NO_UNDO;
+    int at = journal.undo();
+    const int* cells = journal.turnCells(at);
+    if (journal.matched[at])
+    {
+        game.cellStates.unmatch(cells, journal.width);
+        game.hintEngine.onUnmatched(game.board.cells[cells[0]]);
+    }
+    game.turns--;
+    game.totalMoves -= journal.width;
+    game.lastCell = -1;
+    game.undone = true;//the player saw the cards, a refunded turn must not set a best
+    return MOVE_UNDO;
+}
+
+//play the most recently undone turn again, dropping any picks made since
+MoveResult redoTurn(GameSession& game)
+{
+    MoveJournal& journal = game.journal;
+    if (journal.redoable == 0) return MOVE_NO_REDO;
+    undoPicks(game, game.picked);
+    game.picked = 0;
+    int at = journal.redo();
+    const int* cells = journal.turnCells(at);
+    if (journal.matched[at])
+    {
+        for (int n = 0; n < journal.width; n++)
+        {
+            game.cellStates.markMatched(cells[n]);
+        }
+        game.hintEngine.onMatched(game.board.cells[cells[0]]);
+    }
+    game.turns++;
+    game.totalMoves += journal.width;
+    game.lastCell = cells[journal.width - 1];
+    return MOVE_REDO;
+}
+
+//text asking for the next card of the turn
+string turnPrompt(GameSession& game)
+{
+    static const char* const ordinals[] = {"first", "second", "third", "fourth", "fifth",
+                                           "sixth", "seventh", "eighth", "ninth", "tenth"};
+    string range = game.board.rows == game.board.cols
+        ? "row col 0-" + to_string(game.board.rows - 1)
+        : "row 0-" + to_string(game.board.rows - 1) + " col 0-" + to_string(game.board.cols - 1);
+    return "Enter " + string(game.picked < 10 ? ordinals[game.picked] : "next") + " card (" + range +
+           ") or -1 -1 for hint (" + to_string(game.hintsRemaining) +
+           " left), -2 -2 undo, -3 -3 redo, -9 -9 to quit: ";
+}
+
+//what to tell the player after a move, empty if the board says it all
+string resultMessage(GameSession& game, MoveResult result)
+{
+    switch (result)
+    {
+        case MOVE_MATCH:
+            return "Match found!";
+        case MOVE_MISMATCH:
+            return "No match. Flipping back...";
+        case MOVE_INVALID:
+        case MOVE_FORFEIT:
+            return "Invalid move! Try again.";
+        case MOVE_RESTART:
+            return "Invalid input! Please enter two numbers.";
+        case MOVE_HINT:
+            return "Hint: Try card at row " + to_string(game.lastHint.first + 1) +
+                   ", col " + to_string(game.lastHint.second + 1) +
+                   " (" + to_string(game.hintsRemaining) + " hints left)";
+        case MOVE_NO_HINTS:
+            return "No hints remaining!";
+        case MOVE_NO_HINT_FOUND:
+            return "No valid moves available";
+        case MOVE_UNDO:
+            return "Move undone.";
+        case MOVE_REDO:
+            return "Move redone.";
+        case MOVE_NO_UNDO:
+            return "Nothing to undo!";
+        case MOVE_NO_REDO:
+            return "Nothing to redo!";
+        case MOVE_QUIT:
+            return "Quitting to menu...";
+        default:
+            return "";
+    }
+}
+
+//process a single turn
+bool playTurn(GameSession& game)
+{
+    while (true)
+    {
+        displayWithBorder(turnPrompt(game));
+        if (!awaitInput(game))
+        {
+            continue;
+        }
+        int row, col;
+        InputStatus status;
+        consoleInput.awaitToken();//the player's think time stays out of the parse timing
+        {
+            PROFILE_PHASE(PHASE_INPUT);
+            status = consoleInput.readInt(row);
+        }
+        if (status == INPUT_OK)
+        {
+            consoleInput.awaitToken();
+            PROFILE_PHASE(PHASE_INPUT);
+            status = consoleInput.readInt(col);
+        }
+        if (status == INPUT_EOF)
+        {
+            row = col = -9;//nothing more will come, leave the board
+        }
+        else if (status == INPUT_BAD)
+        {
+            MoveResult restarted = restartTurn(game);
+            consoleInput.skipLine();
+            displayNotice(game, resultMessage(game, restarted));
+            continue;
+        }
+        MoveResult result = applyInput(game, row, col);
+        switch (result)
+        {
+            case MOVE_QUIT:
+                displayWithBorder(resultMessage(game, result));
+                return false;
+            case MOVE_HINT:
+            case MOVE_NO_HINTS:
+            case MOVE_NO_HINT_FOUND:
+                getHint(game, result);
+                continue;
+            case MOVE_INVALID:
+            case MOVE_FORFEIT:
+                displayNotice(game, resultMessage(game, result));
+                if (result == MOVE_FORFEIT) return true;
+                continue;
+            case MOVE_FLIPPED:
+                displayBoard(game);
+                continue;
+            case MOVE_UNDO:
+            case MOVE_REDO:
+                displayNotice(game, resultMessage(game, result));
+                return true;
+            case MOVE_NO_UNDO:
+            case MOVE_NO_REDO:
+                displayWithBorder(resultMessage(game, result));
+                continue;
+            case MOVE_MATCH:
+                displayBoard(game);
+                displayWithBorder(resultMessage(game, result));
+                return true;
+            default:
+                displayBoard(game);
+                displayWithBorder(resultMessage(game, result));
+                if (game.revealDuration.count() <= 0)
+                {
+                    finishReveal(game);
+                    displayBoard(game);
+                }
+                return true;
+        }
+    }
+}
+
+//count matched cards
+int countMatches(GameSession& game)
+{
+    return game.cellStates.matchedCount;
+}
+
+//update score in bst
+void updateScore(GameSession& game, int level, int turns)
+{
+    if (game.undone)
+    {
+        cout << "Turns were undone, so this score is not recorded\n";
+        return;
+    }
+    game.scoreTree.insertScore(level, turns);
+    if (game.scoreStore)
+    {
+        game.scoreStore->record(game.playerName, level, turns);
+    }
+    cout << "Best score for Level " << level << ": " << game.scoreTree.findBest(level) << " turns\n";
+}
+
+//pick a card to suggest, {-1, -1} if none qualifies
+pair<int, int> findHint(GameSession& game)
+{
+    pair<int, int> suggestion = {-1, -1};
+    if (!game.cellStates.flippedCells.empty())
+    {
+        //a card is up, point at another copy of it
+        int idx = game.cellStates.flippedCells[0];
+        int row = idx / game.board.cols;
+        int col = idx % game.board.cols;
+        suggestion = adjacentHints ? findMatchAdjacent(game, game.board.cells[idx], row, col) : partnerOf(game, row, col);
+    }
+    else if (!adjacentHints)
+    {
+        if (!game.hintEngine.empty())
+        {
+            int idx = game.cardPositions.at(game.hintEngine.anyUnmatched(), 0);
+            suggestion = {idx / game.board.cols, idx % game.board.cols};
+        }
+    }
+    else
+    {
+        //only suggest a pair whose cards are connected through hidden cells
+        for (int value : game.hintEngine.values())
+        {
+            int idx = game.cardPositions.at(value, 0);
+            pair<int, int> first = {idx / game.board.cols, idx % game.board.cols};
+            if (findMatchAdjacent(game, value, first.first, first.second).first != -1)
+            {
+                suggestion = first;
+                break;
+            }
+        }
+    }
+    return suggestion;
+}
+
+//spend a hint if one is left and a card qualifies
+MoveResult requestHint(GameSession& game)
+{
+    PROFILE_PHASE(PHASE_HINT);
+    if (game.hintsRemaining <= 0) return MOVE_NO_HINTS;
+    game.lastHint = findHint(game);
+    if (game.lastHint.first == -1) return MOVE_NO_HINT_FOUND;
+    game.hintsRemaining--;
+    return MOVE_HINT;
+}
+
+//provide a hint and show the board
+void getHint(GameSession& game, MoveResult result)
+{
+    displayNotice(game, resultMessage(game, result));
+}
+
+//show a message and the board, in ansi mode the message goes under the frame since drawing it clears what is below
+void displayNotice(GameSession& game, const string& message)
+{
+    if (game.renderer.ansi)
+    {
+        displayBoard(game);
+        displayWithBorder(message);
+    }
+    else
+    {
+        displayWithBorder(message);
+        displayBoard(game);
+    }
+}
+
+//display game statistics
+void displayStats(GameSession& game, int turns)
+{
+    cout << "Game Statistics:\n";
+    cout << "Total Turns: " << turns << "\n";
+    cout << "Total Moves: " << game.totalMoves << "\n";
+    cout << "Total Matches: " << (game.cellStates.matchedCount - game.blankCells) / game.matchSize << "\n";
+    cout << "Hints Used: " << (game.hintsRemaining - game.hintsRemaining) << "\n";
+    if (game.board.size() > 256)
+    {
+        cout << "Matched Positions: " << game.cellStates.matchedCount - game.blankCells << " cells\n";
+    }
+    else
+    {
+        cout << "Matched Positions:\n";
+    }
+    for (size_t w = 0; game.board.size() <= 256 && w < game.cellStates.matchedBits.size(); w++)
+    {
+        uint64_t word = game.cellStates.matchedBits[w];
+        while (word)
+        {
+            int idx = w * 64 + __builtin_ctzll(word);
+            word &= word - 1;
+            if (!game.board.cells[idx]) continue;//blank filler
+            cout << "(Row " << idx / game.board.cols + 1 << ", Col " << idx % game.board.cols + 1 << ")\n";
+        }
+    }
+#ifdef MEMORY_MATCH_PROFILE
+    dumpProfile(cout);
+#endif
+    cout << "----------------\n";
+}
+
+//show the main menu
+void showMenu(GameSession& game)
+{
+    string menu;
+    appendMenu(menu, game);
+    cout << menu;
+}
+
+//append the main menu and its prompt
+void appendMenu(string& out, GameSession& game)
+{
+    char par[32];
+    out.append("==== Memory Match Game ====\n");
+    for (int i = 1; i <= MAX_LEVELS; i++)
+    {
+        snprintf(par, sizeof(par), "%g", round(levelPar(i) * 10) / 10);
+        out.append(to_string(i) + ". Level " + to_string(i) + " (" + to_string(2*i) + "x" + to_string(2*i) + ") (Par: " + par + ")");
+        int best = game.scoreTree.findBest(i);
+        if (best != -1)
+        {
+            out.append(" (Best: " + to_string(best) + " turns)");
+        }
+        out.push_back('\n');
+    }
+    out.append(to_string(MAX_LEVELS + 1) + ". Quit\n");
+    out.append(to_string(MAX_LEVELS + 2) + ". Custom board (rows x cols, k of a kind)\n");
+    out.append("========================\n");
+    appendBordered(out, "Select a level: ");
+}
+
+//run a game level
+void runGameLevel(GameSession& game, int level, const string& background)
+{
+    initializeGame(game, level);
+    int turns = playBoard(game, background);
+    if (turns >= 0)
+    {
+        cout << "Congratulations! You won Level " << level << " in " << turns << " turns\n";
+        updateScore(game, level, turns);
+        displayStats(game, turns);
+    }
+    clearLevel(game);
+}
+
+//large-board limit of expectedTurns, within 1e-4 of the exact value from 500 pairs
+double asymptoticTurns(long long pairs)
+{
+    return (3 - 2 * log(2.0)) * pairs + 0.875 - 2 * log(2.0);
+}
+
+//play a rows x cols board where copies cards of a kind make a match
+void runCustomGame(GameSession& game, int rows, int cols, int copies)
+{
+    initializeBoard(game, rows, cols, copies, max(1, min(rows, cols) / 2), game.rng.next());
+    string background = "Custom Board: " + to_string(rows) + "x" + to_string(cols) +
+                        ", match " + to_string(copies) + " of a kind\n";
+    if (copies == 2)
+    {
+        //blank filler does not change the par, only the number of pairs does
+        long long pairs = (long long)rows * cols / 2;
+        string par = to_string(pairs > BANNER_EXACT_PAIRS ? asymptoticTurns(pairs) : expectedTurns(pairs, 1));
+        background += "Par: " + par.substr(0, par.find('.') + 2) + " turns\n";
+    }
+    int turns = playBoard(game, background);
+    if (turns >= 0)
+    {
+        cout << "Congratulations! You cleared the " << rows << "x" << cols << " board in " << turns << " turns\n";
+        displayStats(game, turns);
+    }
+    clearLevel(game);
+}
+
+//play the dealt board until it is cleared, returns turns taken or -1 if the player quit
+int playBoard(GameSession& game, const string& background)
+{
+    if (game.renderer.ansi)
+    {
+        game.renderer.reset(background + "\n");
+    }
+    else
+    {
+        cout << background << "\n";
+    }
+    displayBoard(game);
+    while (countMatches(game) < game.board.size())
+    {
+        if (!playTurn(game))
+        {
+            return -1;
+        }
+    }
+    return game.turns;
+}
+
+//drop the finished or abandoned level's progress
+void clearLevel(GameSession& game)
+{
+    saveReplay(game);
+    game.revealPending = false;
+    game.cellStates.reset(game.board.size());
+    game.lastCell = -1;
+    game.picked = 0;
+    game.hintsRemaining = 0;
+    game.totalMoves = 0;
+}
+
+//append value as a little-endian base-128 varint
+void appendVarint(vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+//decode one varint, returns false if it runs past end or overflows
+bool readVarint(const uint8_t*& at, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; at < end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *at++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+//record one event of the current game if a replay log is open
+void logEvent(GameSession& game, uint64_t event)
+{
+    if (game.replayFile)
+    {
+        appendVarint(game.replayEvents, event);
+    }
+}
+
+//append the finished or abandoned game to the replay log:
+//magic, seed, rows, cols, copies, hints, event byte count, events
+void saveReplay(GameSession& game)
+{
+    if (!game.replayFile || game.board.size() == 0) return;
+    vector<uint8_t> header(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    appendVarint(header, game.dealSeed);
+    appendVarint(header, game.board.rows);
+    appendVarint(header, game.board.cols);
+    appendVarint(header, game.matchSize);
+    appendVarint(header, game.hintsDealt);
+    appendVarint(header, game.replayEvents.size());
+    fwrite(header.data(), 1, header.size(), game.replayFile);
+    fwrite(game.replayEvents.data(), 1, game.replayEvents.size(), game.replayFile);
+    fflush(game.replayFile);
+    game.replayEvents.clear();
+}
+
+//re-run every game in a replay log without rendering and print one csv line per game
+void runReplay(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        cout << "Could not open " << path << "\n";
+        return;
+    }
+    vector<uint8_t> log;
+    uint8_t chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        log.insert(log.end(), chunk, chunk + got);
+    }
+    fclose(file);
+    GameSession game;//replays share one session, nothing is recorded
+    game.revealDuration = chrono::milliseconds(0);
+    const uint8_t* at = log.data();
+    const uint8_t* end = at + log.size();
+    long long games = 0;
+    long long events = 0;
+    auto start = chrono::steady_clock::now();
+    cout << "game,board,copies,seed,events,turns,moves,hints_used,result\n";
+    while (at < end)
+    {
+        uint64_t seed, rows, cols, copies, hints, length;
+        bool ok = end - at >= 4 && memcmp(at, REPLAY_MAGIC, 4) == 0;
+        if (ok)
+        {
+            at += 4;
+            ok = readVarint(at, end, seed) && readVarint(at, end, rows) && readVarint(at, end, cols) &&
+                 readVarint(at, end, copies) && readVarint(at, end, hints) && readVarint(at, end, length) &&
+                 rows >= 1 && cols >= 1 && rows <= MAX_BOARD_SIDE && cols <= MAX_BOARD_SIDE &&
+                 copies >= 2 && copies <= rows * cols && hints <= (uint64_t)numeric_limits<int>::max() &&
+                 length <= uint64_t(end - at);
+        }
+        if (!ok)
+        {
+            cout << "Corrupt replay log at byte " << at - log.data() << "\n";
+            return;
+        }
+        initializeBoard(game, rows, cols, copies, hints, seed);
+        const uint8_t* stop = at + length;
+        long long gameEvents = 0;
+        MoveResult result = MOVE_FLIPPED;
+        while (at < stop && result != MOVE_QUIT)
+        {
+            uint64_t event;
+            if (!readVarint(at, stop, event) || event >= REPLAY_CELL + game.board.size())
+            {
+                cout << "Corrupt replay log at byte " << at - log.data() << "\n";
+                return;
+            }
+            gameEvents++;
+            if (event == REPLAY_HINT)
+            {
+                result = applyInput(game, -1, -1);
+            }
+            else if (event == REPLAY_QUIT)
+            {
+                result = applyInput(game, -9, -9);
+            }
+            else if (event == REPLAY_RESTART)
+            {
+                result = restartTurn(game);
+            }
+            else if (event == REPLAY_OFF_BOARD)
+            {
+                result = applyInput(game, 0, 0);
+            }
+            else if (event == REPLAY_UNDO)
+            {
+                result = applyInput(game, -2, -2);
+            }
+            else if (event == REPLAY_REDO)
+            {
+                result = applyInput(game, -3, -3);
+            }
+            else
+            {
+                int idx = event - REPLAY_CELL;
+                result = applyInput(game, idx / game.board.cols + 1, idx % game.board.cols + 1);
+            }
+        }
+        finishReveal(game);
+        at = stop;
+        games++;
+        events += gameEvents;
+        const char* outcome = countMatches(game) == game.board.size() ? "cleared" : (result == MOVE_QUIT ? "quit" : "unfinished");
+        cout << games << "," << rows << "x" << cols << "," << copies << "," << seed << "," << gameEvents << ","
+             << game.turns << "," << game.totalMoves << "," << game.hintsDealt - game.hintsRemaining << "," << outcome << "\n";
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "# " << games << " games, " << events << " events in " << seconds << " s ("
+         << (seconds > 0 ? events / seconds : 0) << " events/s)\n";
+}
+
+//play one level without console i/o, returns turns taken or -1 if the player stalls
+int playHeadlessGame(GameSession& game, int level, Player& player)
+{
+    initializeGame(game, level);
+    player.startGame(game);
+    int turns = 0;
+    while (countMatches(game) < game.board.size())
+    {
+        for (int pick = 0; pick < game.matchSize; pick++)
+        {
+            auto card = player.chooseCard(game);
+            if (!isValidMove(game, card.first, card.second, true))
+            {
+                return -1;
+            }
+            flipCard(game, card.first, card.second);
+            player.observe(game, card.first, card.second, game.board.at(card.first, card.second));
+        }
+        resolveTurn(game, checkMatch(game));
+        turns++;
+    }
+    return turns;
+}
+
+//build a scripted player by name, nullptr if the name is unknown
+unique_ptr<Player> makePlayer(const string& name, unsigned seed)
+{
+    if (name == "random")
+    {
+        return unique_ptr<Player>(new RandomPlayer(seed));
+    }
+    if (name == "memory")
+    {
+        return unique_ptr<Player>(new MemoryPlayer());
+    }
+    if (name.compare(0, 4, "lru:") == 0 && name.size() > 4 && isdigit(name[4]))
+    {
+        return unique_ptr<Player>(new MemoryPlayer(atoi(name.c_str() + 4), seed));
+    }
+    if (name == "oracle")
+    {
+        return unique_ptr<Player>(new OraclePlayer());
+    }
+    return nullptr;
+}
+
+//simulate every player in a comma separated list, giving one expected-turns curve per player
+void runSimulation(int gamesPerLevel, const string& playerNames, unsigned masterSeed, int threadCount, const vector<int>& bests)
+{
+    vector<string> names;
+    for (size_t start = 0; start <= playerNames.size();)
+    {
+        size_t comma = min(playerNames.find(',', start), playerNames.size());
+        names.push_back(playerNames.substr(start, comma - start));
+        if (!makePlayer(names.back(), 0))
+        {
+            cout << "Unknown player '" << names.back() << "', use random, memory, lru:K or oracle\n";
+            return;
+        }
+        start = comma + 1;
+    }
+    cout << "player,level,board,games,failed,mean_turns,stddev_turns,min_turns,max_turns,mean_moves,best,best_z\n";
+    for (const string& name : names)
+    {
+        simulatePlayer(gamesPerLevel, name, masterSeed, threadCount, bests);
+    }
+}
+
+//run gamesPerLevel headless games of one player on every level across threadCount workers and print aggregate statistics
+void simulatePlayer(int gamesPerLevel, const string& playerName, unsigned masterSeed, int threadCount, const vector<int>& bests)
+{
+    const int batchSize = 64;//games per unit of work
+    vector<WorkQueue> queues(threadCount);
+    int next = 0;
+    for (int level = 1; level <= MAX_LEVELS; level++)
+    {
+        for (long long first = 0; first < gamesPerLevel; first += batchSize)
+        {
+            int count = min<long long>(batchSize, gamesPerLevel - first);
+            queues[next].batches.push_back({level, first, count});
+            next = (next + 1) % threadCount;
+        }
+    }
+    vector<vector<LevelStats>> results(threadCount, vector<LevelStats>(MAX_LEVELS + 1));
+    auto worker = [&](int id)
+    {
+        mt19937 workerRng;//this worker's generator, reseeded per batch
+        GameSession game;//this worker's session, reused for every game it plays
+        vector<LevelStats>& stats = results[id];
+        GameBatch batch;
+        while (true)
+        {
+            bool found = queues[id].popBack(batch);
+            for (int k = 1; !found && k < threadCount; k++)
+            {
+                found = queues[(id + k) % threadCount].stealFront(batch);
+            }
+            if (!found) break;
+            //seed from the batch so results do not depend on which worker ran it
+            seed_seq seq{masterSeed, unsigned(batch.level), unsigned(batch.firstGame), unsigned(batch.firstGame >> 32)};
+            workerRng.seed(seq);
+            game.rng.seed(workerRng());
+            auto player = makePlayer(playerName, workerRng());
+            LevelStats& level = stats[batch.level];
+            for (int played = 0; played < batch.count; played++)
+            {
+                int turns = playHeadlessGame(game, batch.level, *player);
+                level.games++;
+                if (turns < 0)
+                {
+                    level.failed++;
+                    continue;
+                }
+                level.turnSum += turns;
+                level.moveSum += game.totalMoves;
+                level.turnSquares += double(turns) * turns;
+                level.minTurns = min(level.minTurns, turns);
+                level.maxTurns = max(level.maxTurns, turns);
+            }
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int id = 1; id < threadCount; id++)
+    {
+        threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long long totalGames = 0;
+    for (int level = 1; level <= MAX_LEVELS; level++)
+    {
+        LevelStats total;
+        for (int id = 0; id < threadCount; id++)
+        {
+            total.merge(results[id][level]);
+        }
+        totalGames += total.games;
+        long long played = total.games - total.failed;
+        double mean = played ? double(total.turnSum) / played : 0;
+        double variance = played ? total.turnSquares / played - mean * mean : 0;
+        double stddev = sqrt(max(variance, 0.0));
+        int best = bests[level];
+        cout << playerName << "," << level << "," << 2 * level << "x" << 2 * level << "," << total.games << "," << total.failed << ","
+             << mean << "," << stddev << "," << (played ? total.minTurns : 0) << "," << total.maxTurns << ","
+             << (played ? double(total.moveSum) / played : 0) << "," << best << ",";
+        if (best != -1 && stddev > 0)
+        {
+            cout << (best - mean) / stddev;//how many deviations the saved best sits from this player's mean
+        }
+        cout << "\n";
+    }
+    cout << "# " << playerName << ": " << totalGames << " games on " << threadCount << " threads in " << seconds << " s ("
+         << (seconds > 0 ? totalGames / seconds : 0) << " games/s, seed " << masterSeed << ")\n";
+}
+
+//expected turns to clear a board of pairs under optimal perfect-memory play.
+//the state is (u unknown cards, k known cards whose partner is unknown) and each turn
+//flips an unknown card first:
+//  it pairs a known card (k/u): match it, (u-1, k-1)
+//  it is new, then either flip another unknown:
+//      its partner (1/(u-1)): match, (u-2, k)
+//      a known card's partner (k/(u-1)): that pair costs one more turn, (u-2, k)
+//      another new card: (u-2, k+2)
+//    or flip a known card to learn nothing: (u-1, k+1)
+//layer u only reads layers u-1 and u-2, so three rolling layers indexed by k hold the memo,
+//and the k range of a layer is split across threads. boards above 2^16 pairs use the
+//asymptotic (3 - 2 ln 2) n + 7/8 - 2 ln 2, which is within 1e-4 of the exact value by 500 pairs
+double expectedTurns(long long pairs, int threadCount, long long* wasteStates)
+{
+    if (pairs <= 0) return 0;
+    if (pairs > (1 << 16))
+    {
+        return asymptoticTurns(pairs);
+    }
+    int n = pairs;
+    vector<double> layers[3];//E(u, k) for u mod 3
+    for (auto& layer : layers)
+    {
+        layer.assign(n + 2, 0.0);
+    }
+    int workers = n >= 4096 ? max(1, threadCount) : 1;
+    vector<long long> wasted(workers, 0);//states where flipping a known card is strictly better
+    SpinBarrier barrier(workers);
+    auto fill = [&](int id)
+    {
+        for (int u = 1; u <= 2 * n; u++)
+        {
+            double* now = layers[u % 3].data();
+            const double* back1 = layers[(u + 2) % 3].data();
+            const double* back2 = layers[(u + 1) % 3].data();
+            int top = min(u, 2 * n - u);
+            int states = (top - (u & 1)) / 2 + 1;
+            int first = (u & 1) + 2 * int((long long)states * id / workers);
+            int last = (u & 1) + 2 * int((long long)states * (id + 1) / workers);
+            for (int k = first; k < last; k += 2)
+            {
+                double value = k ? double(k) / u * (1 + back1[k - 1]) : 0;
+                if (u > k)
+                {
+                    double other = u - 1;
+                    double flipUnknown = 1 + (back2[k] + k * (1 + back2[k]) +
+                                              (u - k - 2 > 0 ? (u - k - 2) * back2[k + 2] : 0)) / other;
+                    double best = flipUnknown;
+                    if (k > 0 && 1 + back1[k + 1] < flipUnknown - 1e-12)
+                    {
+                        best = 1 + back1[k + 1];
+                        wasted[id]++;
+                    }
+                    value += double(u - k) / u * best;
+                }
+                now[k] = value;
+            }
+            if (workers > 1)
+            {
+                barrier.wait();
+            }
+        }
+    };
+    vector<thread> threads;
+    for (int id = 1; id < workers; id++)
+    {
+        threads.emplace_back(fill, id);
+    }
+    fill(0);
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    if (wasteStates)
+    {
+        *wasteStates = 0;
+        for (long long w : wasted)
+        {
+            *wasteStates += w;
+        }
+    }
+    return layers[(2 * n) % 3][0];
+}
+
+//par for a built-in level, every level computed together on first use
+double levelPar(int level)
+{
+    //filled by the first caller under the static's init guard, reactor threads then only read it
+    static const vector<double> pars = []
+    {
+        vector<double> table(MAX_LEVELS + 1, 0.0);
+        for (int n = 1; n <= MAX_LEVELS; n++)
+        {
+            table[n] = expectedTurns(2LL * n * n, 1);
+        }
+        return table;
+    }();
+    return pars[level];
+}
+
+//print the exact expected turns of square boards next to a monte-carlo run of the perfect-memory player
+void runParTable(int gamesPerBoard, unsigned masterSeed, int threadCount)
+{
+    cout << "level,board,pairs,expected_turns,method,dp_ms,waste_states,mc_games,mc_mean,mc_stderr,mc_z\n";
+    const int levels[] = {1, 2, 3, 4, 5, 6, 7, 8, 16, 32, 64, 128, 512, 2048};
+    GameSession game;
+    game.rng.seed(masterSeed);
+    for (int level : levels)
+    {
+        long long pairs = 2LL * level * level;
+        long long waste = 0;
+        auto start = chrono::steady_clock::now();
+        double expected = expectedTurns(pairs, threadCount, &waste);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << level << "," << 2 * level << "x" << 2 * level << "," << pairs << "," << expected << ","
+             << (pairs > (1 << 16) ? "asymptotic" : "exact") << "," << ms << "," << waste << ",";
+        //monte-carlo up to 64x64, the larger boards take too long per game
+        int games = level <= 32 ? gamesPerBoard : 0;
+        double sum = 0, squares = 0;
+        MemoryPlayer player;
+        for (int g = 0; g < games; g++)
+        {
+            int turns = playHeadlessGame(game, level, player);
+            sum += turns;
+            squares += double(turns) * turns;
+        }
+        if (games > 1)
+        {
+            double mean = sum / games;
+            double stderror = sqrt(max(squares / games - mean * mean, 0.0) / (games - 1));
+            cout << games << "," << mean << "," << stderror << "," << (stderror > 0 ? (mean - expected) / stderror : 0.0);
+        }
+        else
+        {
+            cout << "0,,,";
+        }
+        cout << "\n";
+    }
+}
+
+#ifdef __linux__
+//binary protocol, entered by sending the line "binary" at the menu.
+//client to server: plain varints, a menu choice (MAX_LEVELS + 2 is followed by rows, cols, copies)
+//or, on a board, one replay event code per input (REPLAY_CELL + cell to select).
+//server to client: a varint byte length, then a varint type from ServerMessage and its fields
+enum ServerMessage
+{
+    MSG_MENU = 1,//at the menu, send a level choice
+    MSG_BOARD,//rows, cols, copies, hints of a freshly dealt board with every cell hidden
+    MSG_MOVE,//MoveResult, turns, hints left, hint cell + 1 or 0, delta count, deltas
+    MSG_REVEAL,//delta count, deltas: a mismatch flipped back on its timer
+    MSG_CLEARED,//turns taken, a menu follows
+    MSG_BYE//the connection closes
+};
+
+//a delta is varint(cell * 4 + state), then varint(value) unless the cell went face down
+enum DeltaState
+{
+    DELTA_HIDDEN,
+    DELTA_UP,
+    DELTA_MATCHED
+};
+
+const int SERVER_MAX_BOARD_SIDE = 128;//largest custom board side served, a bigger deal or frame would stall the reactor
+const size_t CLIENT_OUTPUT_CAP = 1 << 18;//unsent bytes past which a client's input is left unread until it drains
+
+//one connected player, owned by the reactor thread that accepted it
+struct ClientSession
+{
+    int fd;//connected socket
+    GameSession game;//this player's game, same engine as the console
+    int level = 0;//level being played, -1 for a custom board, 0 at the menu
+    string input;//bytes of an incomplete line
+    string output;//bytes the socket has not taken yet
+    uint32_t watching = EPOLLIN | EPOLLRDHUP;//events epoll reports for the socket
+    bool closing = false;//close once output drains
+    bool binary = false;//switched to the binary protocol
+    vector<uint8_t> message;//binary message being built
+    vector<int> faceUp;//cards up before the binary input being handled, any number for k of a kind
+};
+
+//one thread's event loop: its own listening socket, epoll set, clients and reveal timers
+struct Reactor
+{
+    int id;//reactor number, mixed into session seeds
+    int poller;//epoll descriptor
+    int listener;//SO_REUSEPORT socket shared with the other reactors' port
+    unordered_map<int, unique_ptr<ClientSession>> clients;//by socket
+    //pending mismatch reveals by deadline, checked against the session when they fire
+    priority_queue<pair<chrono::steady_clock::time_point, int>, vector<pair<chrono::steady_clock::time_point, int>>,
+                   greater<pair<chrono::steady_clock::time_point, int>>> reveals;
+    FastRng seeds;//seeds each new session's deal generator
+};
+
+//lift the open file limit to its hard maximum so thousands of sockets fit
+void raiseFileLimit()
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+//non-blocking loopback listener that other reactors can bind to as well, -1 on failure
+int openListener(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+//blocking connection to a loopback port with nagle off, -1 on failure
+int connectLocal(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return fd;
+}
+
+//board frame and the prompt for the next card
+void appendTurnView(string& out, GameSession& game)
+{
+    out.append(renderBoard(game));
+    appendBordered(out, turnPrompt(game));
+}
+
+//run one line of the text protocol, which follows the console prompts:
+//a menu choice (10 rows cols copies for a custom board), then "row col" or -1 -1 / -2 -2 / -3 -3 / -9 -9
+void handleClientLine(Reactor& reactor, ClientSession& client, char* line)
+{
+    GameSession& game = client.game;
+    string& out = client.output;
+    int numbers[4];
+    int count = 0;
+    bool clean = true;
+    char* at = line;
+    {
+        PROFILE_PHASE(PHASE_INPUT);//only the parse, the move itself is timed by phase
+        while (count < 4)
+        {
+            while (*at == ' ' || *at == '\t' || *at == '\r')
+            {
+                at++;
+            }
+            if (!*at) break;
+            char* end;
+            long value = strtol(at, &end, 10);
+            if (end == at || value < numeric_limits<int>::min() || value > numeric_limits<int>::max())
+            {
+                clean = false;
+                break;
+            }
+            numbers[count++] = value;
+            at = end;
+        }
+    }
+    if (client.level == 0)
+    {
+        if (strncmp(line, "binary", 6) == 0 && (line[6] == '\0' || line[6] == '\r'))
+        {
+            client.binary = true;
+            client.message.assign(1, MSG_MENU);
+            appendMessage(client);
+            return;
+        }
+        int choice = clean && count >= 1 ? numbers[0] : 0;
+        if (choice == MAX_LEVELS + 1)
+        {
+            out.append("Thanks for playing!\n");
+            client.closing = true;
+            return;
+        }
+        if (choice == MAX_LEVELS + 2)
+        {
+            int rows = count == 4 ? numbers[1] : 0;//a short line leaves the other slots unset
+            int cols = count == 4 ? numbers[2] : 0;
+            int copies = count == 4 ? numbers[3] : 0;
+            if (rows >= 1 && cols >= 1 && rows <= SERVER_MAX_BOARD_SIDE && cols <= SERVER_MAX_BOARD_SIDE &&
+                copies >= 2 && copies <= rows * cols)
+            {
+                initializeBoard(game, rows, cols, copies, max(1, min(rows, cols) / 2), game.rng.next());
+                client.level = -1;
+                out.append("Custom Board: " + to_string(rows) + "x" + to_string(cols) + ", match " + to_string(copies) + " of a kind\n");
+                appendTurnView(out, game);
+                return;
+            }
+            appendBordered(out, "Invalid board! Send " + to_string(MAX_LEVELS + 2) + " rows cols copies, sides 1-" +
+                                to_string(SERVER_MAX_BOARD_SIDE) + " and at least two cards per match.");
+        }
+        else if (choice >= 1 && choice <= MAX_LEVELS)
+        {
+            initializeGame(game, choice);
+            client.level = choice;
+            out.append("Level " + to_string(choice) + "\n");
+            appendTurnView(out, game);
+            return;
+        }
+        else
+        {
+            appendBordered(out, "Invalid choice!");
+        }
+        appendMenu(out, game);
+        return;
+    }
+    MoveResult result = clean && count == 2 ? applyInput(game, numbers[0], numbers[1]) : restartTurn(game);
+    string message = resultMessage(game, result);
+    if (result == MOVE_QUIT)
+    {
+        appendBordered(out, message);
+        clearLevel(game);
+        client.level = 0;
+        appendMenu(out, game);
+        return;
+    }
+    if (result == MOVE_MATCH || result == MOVE_MISMATCH)
+    {
+        out.append(renderBoard(game));
+        appendBordered(out, message);
+    }
+    else if (!message.empty())
+    {
+        appendBordered(out, message);
+    }
+    if (result == MOVE_MISMATCH && game.revealPending)
+    {
+        if (game.revealDuration.count() > 0)
+        {
+            reactor.reveals.push({game.revealDeadline, client.fd});//the prompt follows when the cards flip back
+            return;
+        }
+        finishReveal(game);
+    }
+    if (countMatches(game) == game.board.size())
+    {
+        if (client.level > 0)
+        {
+            out.append("Congratulations! You won Level " + to_string(client.level) + " in " + to_string(game.turns) + " turns\n");
+            if (game.undone)
+            {
+                out.append("Turns were undone, so this score is not recorded\n");
+            }
+            else
+            {
+                game.scoreTree.insertScore(client.level, game.turns);
+            }
+        }
+        else
+        {
+            out.append("Congratulations! You cleared the " + to_string(game.board.rows) + "x" + to_string(game.board.cols) +
+                       " board in " + to_string(game.turns) + " turns\n");
+        }
+        clearLevel(game);
+        client.level = 0;
+        appendMenu(out, game);
+        return;
+    }
+    if (result == MOVE_NO_UNDO || result == MOVE_NO_REDO || result == MOVE_MATCH)
+    {
+        appendBordered(out, turnPrompt(game));
+    }
+    else
+    {
+        appendTurnView(out, game);
+    }
+}
+
+//frame the message being built onto the output
+void appendMessage(ClientSession& client)
+{
+    uint8_t length[10];
+    int size = 0;
+    for (uint64_t value = client.message.size(); ; value >>= 7)
+    {
+        length[size++] = uint8_t(value & 0x7f) | (value >= 0x80 ? 0x80 : 0);
+        if (value < 0x80) break;
+    }
+    client.output.append((const char*)length, size);
+    client.output.append((const char*)client.message.data(), client.message.size());
+}
+
+void appendDelta(vector<uint8_t>& out, GameSession& game, int cell, int state)
+{
+    appendVarint(out, uint64_t(cell) * 4 + state);
+    if (state != DELTA_HIDDEN)
+    {
+        appendVarint(out, game.board.cells[cell]);
+    }
+}
+
+//run every complete binary input from start on, returns the offset of the first byte left unread
+size_t handleClientBinary(Reactor& reactor, ClientSession& client, size_t start)
+{
+    GameSession& game = client.game;
+    const uint8_t* base = (const uint8_t*)client.input.data();
+    const uint8_t* end = base + client.input.size();
+    const uint8_t* at = base + start;
+    while (at < end && !client.closing && client.output.size() <= CLIENT_OUTPUT_CAP)
+    {
+        const uint8_t* next = at;
+        uint64_t code;
+        if (!readVarint(next, end, code)) break;
+        if (client.level == 0)
+        {
+            if (code == MAX_LEVELS + 1)
+            {
+                client.message.assign(1, MSG_BYE);
+                appendMessage(client);
+                client.closing = true;
+                return next - base;
+            }
+            if (code == MAX_LEVELS + 2)
+            {
+                uint64_t rows, cols, copies;
+                if (!readVarint(next, end, rows) || !readVarint(next, end, cols) || !readVarint(next, end, copies)) break;
+                if (rows >= 1 && cols >= 1 && rows <= SERVER_MAX_BOARD_SIDE && cols <= SERVER_MAX_BOARD_SIDE &&
+                    copies >= 2 && copies <= rows * cols)
+                {
+                    initializeBoard(game, rows, cols, copies, max<int>(1, min(rows, cols) / 2), game.rng.next());
+                    client.level = -1;
+                }
+            }
+            else if (code >= 1 && code <= MAX_LEVELS)
+            {
+                initializeGame(game, code);
+                client.level = code;
+            }
+            if (client.level != 0)
+            {
+                client.message.assign(1, MSG_BOARD);
+                appendVarint(client.message, game.board.rows);
+                appendVarint(client.message, game.board.cols);
+                appendVarint(client.message, game.matchSize);
+                appendVarint(client.message, game.hintsRemaining);
+            }
+            else
+            {
+                client.message.assign(1, MSG_MENU);
+            }
+            appendMessage(client);
+            at = next;
+            continue;
+        }
+        at = next;
+        //cells that change face: a due reveal, then this turn's picks
+        int flippedBack = game.revealPending ? game.cellStates.flippedCells.size() : 0;
+        vector<int>& before = client.faceUp;
+        before.assign(game.cellStates.flippedCells.begin(), game.cellStates.flippedCells.end());
+        int beforeCount = before.size();
+        int selected = -1;
+        MoveResult result;
+        if (code == REPLAY_RESTART)
+        {
+            result = restartTurn(game);
+        }
+        else if (code >= REPLAY_CELL && code < REPLAY_CELL + game.board.size())
+        {
+            selected = code - REPLAY_CELL;
+            result = applyInput(game, selected / game.board.cols + 1, selected % game.board.cols + 1);
+        }
+        else
+        {
+            int command = code == REPLAY_HINT ? -1 : code == REPLAY_QUIT ? -9 : code == REPLAY_UNDO ? -2 : code == REPLAY_REDO ? -3 : 0;
+            result = applyInput(game, command, command);
+        }
+        vector<uint8_t> deltas;//pairs are small, a turn changes at most a few cells
+        int deltaCount = 0;
+        for (int n = 0; n < flippedBack && n < beforeCount; n++, deltaCount++)
+        {
+            appendDelta(deltas, game, before[n], DELTA_HIDDEN);
+        }
+        const MoveJournal& journal = game.journal;
+        switch (result)
+        {
+            case MOVE_FLIPPED:
+                appendDelta(deltas, game, selected, DELTA_UP);
+                deltaCount++;
+                break;
+            case MOVE_MATCH:
+                for (int n = 0; n < journal.width; n++, deltaCount++)
+                {
+                    int at = journal.head == 0 ? journal.capacity - 1 : journal.head - 1;
+                    appendDelta(deltas, game, journal.turnCells(at)[n], DELTA_MATCHED);
+                }
+                break;
+            case MOVE_MISMATCH:
+                appendDelta(deltas, game, selected, DELTA_UP);
+                deltaCount++;
+                if (game.revealDuration.count() <= 0)
+                {
+                    int at = journal.head == 0 ? journal.capacity - 1 : journal.head - 1;
+                    for (int n = 0; n < journal.width; n++, deltaCount++)
+                    {
+                        appendDelta(deltas, game, journal.turnCells(at)[n], DELTA_HIDDEN);
+                    }
+                    finishReveal(game);
+                }
+                else
+                {
+                    reactor.reveals.push({game.revealDeadline, client.fd});
+                }
+                break;
+            case MOVE_FORFEIT:
+            case MOVE_RESTART:
+            case MOVE_UNDO:
+            case MOVE_REDO:
+            {
+                bool picksDropped = !flippedBack && beforeCount > 0;
+                if (picksDropped)
+                {
+                    for (int n = 0; n < beforeCount; n++, deltaCount++)
+                    {
+                        appendDelta(deltas, game, before[n], DELTA_HIDDEN);//this turn's picks went face down
+                    }
+                }
+                if ((result == MOVE_UNDO && !picksDropped) || result == MOVE_REDO)
+                {
+                    int at = result == MOVE_UNDO ? journal.head : (journal.head == 0 ? journal.capacity - 1 : journal.head - 1);
+                    if (journal.matched[at])
+                    {
+                        for (int n = 0; n < journal.width; n++, deltaCount++)
+                        {
+                            appendDelta(deltas, game, journal.turnCells(at)[n], result == MOVE_UNDO ? DELTA_HIDDEN : DELTA_MATCHED);
+                        }
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        client.message.assign(1, MSG_MOVE);
+        appendVarint(client.message, result);
+        appendVarint(client.message, game.turns);
+        appendVarint(client.message, game.hintsRemaining);
+        appendVarint(client.message, result == MOVE_HINT ? game.board.index(game.lastHint.first, game.lastHint.second) + 1 : 0);
+        appendVarint(client.message, deltaCount);
+        client.message.insert(client.message.end(), deltas.begin(), deltas.end());
+        appendMessage(client);
+        if (result == MOVE_QUIT || countMatches(game) == game.board.size())
+        {
+            if (result != MOVE_QUIT)
+            {
+                if (client.level > 0 && !game.undone)
+                {
+                    game.scoreTree.insertScore(client.level, game.turns);
+                }
+                client.message.assign(1, MSG_CLEARED);
+                appendVarint(client.message, game.turns);
+                appendMessage(client);
+            }
+            clearLevel(game);
+            client.level = 0;
+            client.message.assign(1, MSG_MENU);
+            appendMessage(client);
+        }
+    }
+    return at - base;
+}
+
+//write as much pending output as the socket takes, watching for writability while some is left
+void flushClient(Reactor& reactor, ClientSession& client)
+{
+    size_t sent = 0;
+    while (sent < client.output.size())
+    {
+        ssize_t wrote = send(client.fd, client.output.data() + sent, client.output.size() - sent, MSG_NOSIGNAL);
+        if (wrote > 0)
+        {
+            sent += wrote;
+            continue;
+        }
+        if (wrote < 0 && errno == EINTR) continue;
+        if (wrote < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeClient(reactor, client.fd);
+        return;
+    }
+    client.output.erase(0, sent);
+    bool pending = !client.output.empty();
+    if (!pending && client.closing)
+    {
+        closeClient(reactor, client.fd);
+        return;
+    }
+    //a client that sends moves without reading the replies stops being read
+    uint32_t wanted = (client.output.size() > CLIENT_OUTPUT_CAP ? 0 : EPOLLIN | EPOLLRDHUP) | (pending ? EPOLLOUT : 0);
+    if (wanted != client.watching)
+    {
+        epoll_event event = {};
+        event.events = wanted;
+        event.data.fd = client.fd;
+        epoll_ctl(reactor.poller, EPOLL_CTL_MOD, client.fd, &event);
+        client.watching = wanted;
+    }
+}
+
+//run the buffered input's complete lines or binary inputs while the output backlog is under its cap
+void serveInput(Reactor& reactor, ClientSession& client)
+{
+    size_t start = 0;
+    size_t newline;
+    while (!client.closing && !client.binary && client.output.size() <= CLIENT_OUTPUT_CAP &&
+           (newline = client.input.find('\n', start)) != string::npos)
+    {
+        client.input[newline] = '\0';
+        handleClientLine(reactor, client, &client.input[start]);
+        start = newline + 1;
+    }
+    if (client.binary && !client.closing)
+    {
+        start = handleClientBinary(reactor, client, start);
+    }
+    client.input.erase(0, start);
+}
+
+void closeClient(Reactor& reactor, int fd)
+{
+    epoll_ctl(reactor.poller, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    reactor.clients.erase(fd);
+}
+
+//accept, read, run and time out sessions on one thread until the process exits
+void runReactor(int port, unsigned masterSeed, int id)
+{
+    Reactor reactor;
+    reactor.id = id;
+    reactor.seeds.seed((uint64_t(masterSeed) << 16) ^ id);
+    reactor.listener = openListener(port);
+    reactor.poller = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor.listener < 0 || reactor.poller < 0)
+    {
+        cerr << "Reactor " << id << " could not listen on port " << port << "\n";
+        return;
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = reactor.listener;
+    epoll_ctl(reactor.poller, EPOLL_CTL_ADD, reactor.listener, &event);
+    epoll_event ready[256];
+    char chunk[16384];
+    while (true)
+    {
+        int timeout = -1;
+        if (!reactor.reveals.empty())
+        {
+            auto wait = reactor.reveals.top().first - chrono::steady_clock::now();
+            timeout = max<long long>(0, chrono::duration_cast<chrono::milliseconds>(wait + chrono::microseconds(999)).count());
+        }
+        int count = epoll_wait(reactor.poller, ready, 256, timeout);
+        for (int e = 0; e < count; e++)
+        {
+            int fd = ready[e].data.fd;
+            if (fd == reactor.listener)
+            {
+                int socketFd;
+                while ((socketFd = accept4(reactor.listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                {
+                    int on = 1;
+                    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                    unique_ptr<ClientSession> client(new ClientSession());
+                    client->fd = socketFd;
+                    client->game.rng.seed(reactor.seeds.next());
+                    client->game.revealDuration = chrono::milliseconds(revealMillis);
+                    client->game.renderer.ansi = false;
+                    appendMenu(client->output, client->game);
+                    epoll_event watch = {};
+                    watch.events = EPOLLIN | EPOLLRDHUP;
+                    watch.data.fd = socketFd;
+                    epoll_ctl(reactor.poller, EPOLL_CTL_ADD, socketFd, &watch);
+                    ClientSession& added = *client;
+                    reactor.clients[socketFd] = move(client);
+                    flushClient(reactor, added);
+                }
+                continue;
+            }
+            auto found = reactor.clients.find(fd);
+            if (found == reactor.clients.end()) continue;
+            ClientSession& client = *found->second;
+            if (ready[e].events & (EPOLLERR | EPOLLHUP))
+            {
+                closeClient(reactor, fd);
+                continue;
+            }
+            if (ready[e].events & EPOLLOUT)
+            {
+                flushClient(reactor, client);
+                if (!reactor.clients.count(fd)) continue;
+                if (!client.input.empty() && client.output.size() <= CLIENT_OUTPUT_CAP)
+                {
+                    serveInput(reactor, client);//moves held back while the backlog was over its cap
+                    flushClient(reactor, client);
+                    if (!reactor.clients.count(fd)) continue;
+                }
+            }
+            if (!(ready[e].events & (EPOLLIN | EPOLLRDHUP))) continue;
+            bool hungUp = false;
+            while (!client.closing && client.output.size() <= CLIENT_OUTPUT_CAP)
+            {
+                ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+                if (got > 0)
+                {
+                    client.input.append(chunk, got);
+                    serveInput(reactor, client);
+                    continue;
+                }
+                if (got < 0 && errno == EINTR) continue;
+                hungUp = got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+            if (hungUp || (client.output.size() <= CLIENT_OUTPUT_CAP && client.input.size() > 4096))
+            {
+                closeClient(reactor, fd);//peer left, or a line that long is not a move
+                continue;
+            }
+            flushClient(reactor, client);
+        }
+        //flip back every mismatch whose deadline has passed and send the next prompt
+        auto now = chrono::steady_clock::now();
+        while (!reactor.reveals.empty() && reactor.reveals.top().first <= now)
+        {
+            int fd = reactor.reveals.top().second;
+            reactor.reveals.pop();
+            auto found = reactor.clients.find(fd);
+            if (found == reactor.clients.end()) continue;
+            ClientSession& client = *found->second;
+            if (!client.game.revealPending || now < client.game.revealDeadline) continue;
+            if (client.binary)
+            {
+                const vector<int>& up = client.game.cellStates.flippedCells;
+                client.message.assign(1, MSG_REVEAL);
+                appendVarint(client.message, up.size());
+                for (int cell : up)
+                {
+                    appendDelta(client.message, client.game, cell, DELTA_HIDDEN);
+                }
+                appendMessage(client);
+                tickReveal(client.game, now);
+            }
+            else
+            {
+                tickReveal(client.game, now);
+                appendTurnView(client.output, client.game);
+            }
+            flushClient(reactor, client);
+        }
     }
-};
-
-ScoreBST scoreTree;//bst instance for scores
-
-//function declarations
-void displayWithBorder(const string& text);
-void initializeGame(int level);
-void displayBoard();
-bool checkMatch();
-bool isValidMove(int row, int col, bool checkPrevious = false);
-bool playTurn(int& turns);
-int countMatches();
-void showMenu();
-void updateScore(int level, int turns);
-void getHint();
-void displayStats(int turns);
-void playLevel1();
-void playLevel2();
-void playLevel3();
-void playLevel4();
-void playLevel5();
-void playLevel6();
-void playLevel7();
-void playLevel8();
-pair<int, int> findMatchRecursive(int value, const set<pair<int, int>>& visited, int row, int col);
-void mergeSort(vector<int>& arr, int left, int right);
-void merge(vector<int>& arr, int left, int mid, int right);
-vector<pair<int, int>> getAdjacentCards(pair<int, int> pos);
-
-//display text with a bordered format
-void displayWithBorder(const string& text)
-{
-    int width = text.length() + 4;//calculate border width
-    string topBottomBorder(width, '-');
-    cout << topBottomBorder << "\n";
-    cout << "| " << text << " |\n";
-    cout << topBottomBorder << "\n";
 }
 
-//merge function for merge sort
-void merge(vector<int>& arr, int left, int mid, int right)
+//serve the text protocol on a loopback port with one reactor per thread
+void runServer(int port, unsigned masterSeed, int threadCount)
 {
-    vector<int> leftArr(arr.begin() + left, arr.begin() + mid + 1);
-    vector<int> rightArr(arr.begin() + mid + 1, arr.begin() + right + 1);
-    int i = 0;
-    int j = 0;
-    int k = left;
-    while (i < leftArr.size() && j < rightArr.size())
+    raiseFileLimit();
+    int probe = openListener(port);
+    if (probe < 0)
     {
-        if (leftArr[i] <= rightArr[j])
-        {
-            arr[k] = leftArr[i];
-            i++;
-            k++;
-        }
-        else
-        {
-            arr[k] = rightArr[j];
-            j++;
-            k++;
-        }
+        cout << "Could not listen on port " << port << "\n";
+        return;
     }
-    while (i < leftArr.size())
+    ::close(probe);
+    cout << "Serving on 127.0.0.1:" << port << " with " << threadCount << " reactor" << (threadCount == 1 ? "" : "s") << "\n";
+    cout.flush();
+    vector<thread> threads;
+    for (int id = 1; id < threadCount; id++)
     {
-        arr[k] = leftArr[i];
-        i++;
-        k++;
+        threads.emplace_back(runReactor, port, masterSeed, id);
     }
-    while (j < rightArr.size())
+    runReactor(port, masterSeed, 0);
+    for (auto& t : threads)
     {
-        arr[k] = rightArr[j];
-        j++;
-        k++;
+        t.join();
     }
 }
 
-//recursive merge sort
-void mergeSort(vector<int>& arr, int left, int right)
+//true once text ends with a bordered prompt, which closes every server reply
+bool endsWithPrompt(const string& text)
 {
-    if (left < right)
-    {
-        int mid = left + (right - left) / 2;
-        mergeSort(arr, left, mid);
-        mergeSort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
-    }
+    if (text.size() < 8 || text.back() != '\n') return false;
+    size_t dashes = text.find_last_not_of('-', text.size() - 2);
+    return dashes != string::npos && dashes >= 4 && text.compare(dashes - 4, 5, ":  |\n") == 0;
 }
 
-//initialize game board
-void initializeGame(int level)
+//hold idleClients connections open at the menu, then time probeMoves selections on one more connection
+void runIdleTest(int port, int idleClients, int probeMoves)
 {
-    currentBoardSize = 2 * level;//set board size
-    int totalCards = currentBoardSize * currentBoardSize;
-    int pairs = totalCards / 2;
-    vector<int> cardValues;
-    hintsRemaining = level;//set hints per level
-    cardPositions.clear();//clear hash table
-    for (int i = 1; i <= pairs; i++)
+    raiseFileLimit();
+    vector<int> idle;
+    string reply;
+    char chunk[16384];
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < idleClients; i++)
     {
-        cardValues.push_back(i);
-        cardValues.push_back(i);
+        int fd = connectLocal(port);
+        if (fd < 0)
+        {
+            cout << "Connection " << i << " failed: " << strerror(errno) << "\n";
+            break;
+        }
+        idle.push_back(fd);
     }
-    mergeSort(cardValues, 0, cardValues.size() - 1);//sort using merge sort
-    random_device rd;
-    mt19937 g(rd());
-    shuffle(cardValues.begin(), cardValues.end(), g);//shuffle cards
-    board.clear();
-    int index = 0;
-    for (int i = 0; i < currentBoardSize; i++)
+    //every idle session must have been greeted with the menu
+    int greeted = 0;
+    for (int fd : idle)
     {
-        for (int j = 0; j < currentBoardSize; j++)
+        reply.clear();
+        while (!endsWithPrompt(reply))
         {
-            board[make_pair(i, j)] = cardValues[index];
-            cardPositions[cardValues[index]].push_back({i, j});
-            index++;
+            ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+            if (got <= 0) break;
+            reply.append(chunk, got);
         }
+        greeted += endsWithPrompt(reply);
     }
-    flipped.clear();
-    matched.clear();
-    moveHistory = queue<pair<int, int>>();
-}
-
-//display the game board
-void displayBoard()
-{
-    cout << "     ";
-    for (int j = 0; j < currentBoardSize; j++)
+    double connectMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "idle_sessions," << greeted << "/" << idleClients << ",connect_ms," << connectMs << "\n";
+    int fd = connectLocal(port);
+    if (fd < 0)
     {
-        cout << j + 1 << " ";
+        cout << "Probe connection failed\n";
+        return;
     }
-    cout << "\n";
-    string colSeparator(currentBoardSize * 2 + 1, '_');
-    cout << "    " << colSeparator << "\n";
-    for (int i = 0; i < currentBoardSize; i++)
+    //play selections on a level 8 board, starting a new board whenever one is cleared
+    vector<double> latencies;
+    latencies.reserve(probeMoves);
+    auto roundTrip = [&](const string& line)
     {
-        cout << i + 1 << "   |";
-        for (int j = 0; j < currentBoardSize; j++)
+        auto sentAt = chrono::steady_clock::now();
+        send(fd, line.data(), line.size(), MSG_NOSIGNAL);
+        reply.clear();
+        while (!endsWithPrompt(reply))
         {
-            if (flipped.count({i, j}) || matched.count({i, j}))
-            {
-                cout << board[{i, j}] << " ";
-            }
-            else
-            {
-                cout << "- ";
-            }
+            ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+            if (got <= 0) return false;
+            reply.append(chunk, got);
         }
-        cout << "|\n";
+        latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - sentAt).count());
+        return true;
+    };
+    reply.clear();
+    while (!endsWithPrompt(reply))
+    {
+        ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+        if (got <= 0) break;
+        reply.append(chunk, got);
     }
-    string bottomBorder(currentBoardSize * 2 + 1, '-');
-    cout << "    " << bottomBorder << "\n";
-}
-
-//check if flipped cards match
-bool checkMatch()
-{
-    if (flipped.size() != 2) return false;
-    auto it1 = flipped.begin();
-    auto it2 = next(it1);
-    return board[*it1] == board[*it2];
-}
-
-//validate a move
-bool isValidMove(int row, int col, bool checkPrevious)
-{
-    bool validBounds = row >= 0 && row < currentBoardSize &&
-                       col >= 0 && col < currentBoardSize &&
-                       !flipped.count({row, col}) &&
-                       !matched.count({row, col});
-    if (!validBounds) return false;
-    if (checkPrevious && !moveHistory.empty())
+    bool alive = roundTrip("8\n");
+    for (int move = 0; alive && (int)latencies.size() < probeMoves; move++)
     {
-        auto lastMove = moveHistory.back();
-        if (lastMove.first == row && lastMove.second == col)
+        int idx = move % 256;
+        alive = roundTrip(to_string(idx / 16 + 1) + " " + to_string(idx % 16 + 1) + "\n");
+        if (alive && reply.find("Select a level") != string::npos)
         {
-            return false;
+            alive = roundTrip("8\n");
         }
     }
-    return true;
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double q) { return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, size_t(q * latencies.size()))]; };
+    cout << "probe_round_trips," << latencies.size() << ",p50_us," << percentile(0.5) << ",p99_us," << percentile(0.99)
+         << ",max_us," << (latencies.empty() ? 0.0 : latencies.back()) << "\n";
+    //the idle sessions must still be open
+    int open = 0;
+    for (int idleFd : idle)
+    {
+        pollfd check = {idleFd, POLLIN, 0};
+        open += poll(&check, 1, 0) == 0;
+        ::close(idleFd);
+    }
+    ::close(fd);
+    cout << "idle_sessions_open_after," << open << "/" << idle.size() << "\n";
 }
 
-//get adjacent cards for hints
-vector<pair<int, int>> getAdjacentCards(pair<int, int> pos)
+//read the value of cell idx from the first classic board frame in a server reply, -1 if it is not shown
+int frameValue(const string& reply, const Board& board, int values, int idx)
 {
-    vector<pair<int, int>> adj;
-    int row = pos.first;
-    int col = pos.second;
-    vector<pair<int, int>> directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-    for (const auto& dir : directions)
+    int labelWidth = digitCount(board.rows);
+    int cellWidth = max(digitCount(values), digitCount(board.cols));
+    string label;
+    appendPadded(label, idx / board.cols + 1, labelWidth);
+    label.append("   |");
+    size_t line = 0;
+    while (line < reply.size())
     {
-        int newRow = row + dir.first;
-        int newCol = col + dir.second;
-        if (isValidMove(newRow, newCol, false))
+        if (reply.compare(line, label.size(), label) == 0)
         {
-            adj.push_back({newRow, newCol});
+            size_t cell = line + label.size() + (idx % board.cols) * (cellWidth + 1);
+            int value = 0;
+            for (int n = 0; n < cellWidth && cell + n < reply.size(); n++)
+            {
+                char c = reply[cell + n];
+                if (isdigit((unsigned char)c))
+                {
+                    value = value * 10 + (c - '0');
+                }
+            }
+            return value > 0 ? value : -1;
         }
+        line = reply.find('\n', line);
+        line = line == string::npos ? reply.size() : line + 1;
     }
-    return adj;
+    return -1;
 }
 
-//recursive function to find a matching card
-pair<int, int> findMatchRecursive(int value, const set<pair<int, int>>& visited, int row, int col)
+//one simulated player of the load test, keeping a mirror of what it has seen of its board
+struct LoadPlayer
 {
-    if (visited.count({row, col}) || !isValidMove(row, col, false))
-    {
-        return {-1, -1};
-    }
-    if (board[{row, col}] == value && !matched.count({row, col}))
-    {
-        return {row, col};
-    }
-    set<pair<int, int>> newVisited = visited;
-    newVisited.insert({row, col});
-    auto adj = getAdjacentCards({row, col});
-    for (const auto& nextPos : adj)
-    {
-        auto result = findMatchRecursive(value, newVisited, nextPos.first, nextPos.second);
-        if (result.first != -1) return result;
-    }
-    return {-1, -1};
-}
+    int fd = -1;//connection to the server
+    GameSession mirror;//board as far as the player has seen it
+    MemoryPlayer policy;//perfect-memory solver choosing the moves
+    string reply;//bytes of the reply being received, binary frames not yet read
+    int pendingCell = -1;//cell whose selection awaits a reply, -1 for a menu choice
+    int gamesLeft = 0;//boards still to play, including the current one
+    bool greeted = false;//menu received
+    chrono::steady_clock::time_point sentAt;//when the pending line was sent
+    double turnUs = 0;//round trips so far in this turn
+};
 
-//process a single turn
-bool playTurn(int& turns)
+//play gamesPerPlayer boards of a level with players perfect-memory clients over the text or binary protocol and
+//report move and turn round-trip percentiles, throughput and wire bytes per turn, optionally hosting the server in process
+void runLoadTest(int port, int players, int level, int gamesPerPlayer, int threadCount, bool startServer, bool binary,
+                 unsigned masterSeed)
 {
-    int row1, col1, row2, col2;
-    bool validTurn = false;
-    while (!validTurn)
+    raiseFileLimit();
+    if (startServer)
     {
-        displayWithBorder("Enter first card (row col 0-" + to_string(currentBoardSize - 1) +
-                         ") or -1 -1 for hint (" + to_string(hintsRemaining) +
-                         " left), -9 -9 to quit: ");
-        if (!(cin >> row1 >> col1))
+        for (int id = 0; id < threadCount; id++)
         {
-            displayWithBorder("Invalid input! Please enter two numbers.");
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            displayBoard();
-            continue;
+            thread(runReactor, port, masterSeed, id).detach();
         }
-        if (row1 == -9 && col1 == -9)
+    }
+    struct LoadResults
+    {
+        vector<double> moveUs;//round trip of every selection
+        vector<double> turnUs;//summed round trips of every completed turn
+        long long games = 0;//boards cleared
+        long long errors = 0;//lost connections and rejected moves
+        long long bytesSent = 0;//client to server
+        long long bytesReceived = 0;//server to client
+    };
+    vector<LoadResults> results(threadCount);
+    atomic<int> connected{0};
+    auto client = [&](int id)
+    {
+        LoadResults& out = results[id];
+        int first = (long long)players * id / threadCount;
+        int last = (long long)players * (id + 1) / threadCount;
+        vector<LoadPlayer> group(last - first);
+        int poller = epoll_create1(EPOLL_CLOEXEC);
+        int active = 0;
+        int values = 2 * level * level;
+        for (size_t p = 0; p < group.size(); p++)
         {
-            displayWithBorder("Quitting to menu...");
-            return false;
+            LoadPlayer& player = group[p];
+            for (int attempt = 0; player.fd < 0 && attempt < 200; attempt++)
+            {
+                player.fd = connectLocal(port);
+                if (player.fd < 0)
+                {
+                    this_thread::sleep_for(chrono::milliseconds(10));//in-process reactors may still be starting
+                }
+            }
+            if (player.fd < 0)
+            {
+                out.errors++;
+                continue;
+            }
+            fcntl(player.fd, F_SETFL, fcntl(player.fd, F_GETFL) | O_NONBLOCK);
+            player.gamesLeft = gamesPerPlayer;
+            epoll_event watch = {};
+            watch.events = EPOLLIN;
+            watch.data.u32 = p;
+            epoll_ctl(poller, EPOLL_CTL_ADD, player.fd, &watch);
+            active++;
+            connected++;
         }
-        if (row1 == -1 && col1 == -1)
+        auto sendLine = [&](LoadPlayer& player, const string& line)
         {
-            getHint();
-            displayBoard();
-            continue;
-        }
-        if (!isValidMove(row1 - 1, col1 - 1, true))
+            if (!binary)
+            {
+                player.reply.clear();
+            }
+            player.sentAt = chrono::steady_clock::now();
+            out.bytesSent += line.size();
+            return send(player.fd, line.data(), line.size(), MSG_NOSIGNAL) == (ssize_t)line.size();
+        };
+        auto levelChoice = [&]()
         {
-            displayWithBorder("Invalid move! Try again.");
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            displayBoard();
-            continue;
-        }
-        flipped.insert({row1 - 1, col1 - 1});
-        moveHistory.push({row1 - 1, col1 - 1});
-        totalMoves++;
-        displayBoard();
-        validTurn = true;
-    }
-    validTurn = false;
-    while (!validTurn)
-    {
-        displayWithBorder("Enter second card (row col 0-" + to_string(currentBoardSize - 1) +
-                         ") or -1 -1 for hint (" + to_string(hintsRemaining) +
-                         " left), -9 -9 to quit: ");
-        if (!(cin >> row2 >> col2))
-        {
-            displayWithBorder("Invalid input! Please enter two numbers.");
-            flipped.erase({row1 - 1, col1 - 1});
-            moveHistory.pop();
-            totalMoves--;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            displayBoard();
-            continue;
-        }
-        if (row2 == -9 && col2 == -9)
+            if (!binary) return to_string(level) + "\n";
+            vector<uint8_t> code;
+            appendVarint(code, level);
+            return string(code.begin(), code.end());
+        };
+        auto nextMove = [&](LoadPlayer& player)
         {
-            displayWithBorder("Quitting to menu...");
-            flipped.erase({row1 - 1, col1 - 1});
-            moveHistory.pop();
-            totalMoves--;
-            return false;
-        }
-        if (row2 == -1 && col2 == -1)
+            auto card = player.policy.chooseCard(player.mirror);
+            player.pendingCell = player.mirror.board.index(card.first, card.second);
+            if (!binary) return sendLine(player, to_string(card.first + 1) + " " + to_string(card.second + 1) + "\n");
+            vector<uint8_t> code;
+            appendVarint(code, REPLAY_CELL + player.pendingCell);
+            return sendLine(player, string(code.begin(), code.end()));
+        };
+        auto startBoard = [&](LoadPlayer& player)
         {
-            getHint();
-            displayBoard();
-            continue;
+            GameSession& mirror = player.mirror;
+            mirror.board.resize(2 * level, 2 * level);
+            mirror.cellStates.reset(mirror.board.size());
+            mirror.cardPositions.reset(values, 2);
+            mirror.matchSize = 2;
+            mirror.lastCell = -1;
+            player.policy.startGame(mirror);
+            player.turnUs = 0;
+            return nextMove(player);
+        };
+        //mirror the answer to the pending selection, then pick the next card unless the board is done
+        auto seeCard = [&](LoadPlayer& player, int value, double us)
+        {
+            out.moveUs.push_back(us);
+            player.turnUs += us;
+            GameSession& mirror = player.mirror;
+            int idx = player.pendingCell;
+            mirror.board.cells[idx] = value;
+            mirror.cellStates.flip(idx);
+            mirror.lastCell = idx;
+            player.policy.observe(mirror, idx / mirror.board.cols, idx % mirror.board.cols, value);
+            if ((int)mirror.cellStates.flippedCells.size() == mirror.matchSize)
+            {
+                const vector<int>& up = mirror.cellStates.flippedCells;
+                if (mirror.board.cells[up[0]] == mirror.board.cells[up[1]])
+                {
+                    mirror.cellStates.matchFlipped();
+                }
+                else
+                {
+                    mirror.cellStates.clearFlipped();
+                }
+                out.turnUs.push_back(player.turnUs);
+                player.turnUs = 0;
+            }
+            if (mirror.cellStates.matchedCount == mirror.board.size())
+            {
+                player.pendingCell = -1;//the win announcement follows
+                return true;
+            }
+            return nextMove(player);
+        };
+        auto clearedBoard = [&](LoadPlayer& player)
+        {
+            out.games++;
+            player.pendingCell = -1;
+            if (--player.gamesLeft == 0) return false;
+            return sendLine(player, levelChoice());
+        };
+        //act on every complete binary frame received, false once the player is done or broken
+        auto readFrames = [&](LoadPlayer& player, double us, bool& ok)
+        {
+            const uint8_t* base = (const uint8_t*)player.reply.data();
+            const uint8_t* end = base + player.reply.size();
+            const uint8_t* at = base;
+            uint64_t length;
+            while (ok && readVarint(at, end, length) && length <= uint64_t(end - at))
+            {
+                const uint8_t* frame = at;
+                const uint8_t* frameEnd = at + length;
+                at = frameEnd;
+                uint64_t type = 0;
+                readVarint(frame, frameEnd, type);
+                if (type == MSG_BOARD)
+                {
+                    ok = startBoard(player);
+                }
+                else if (type == MSG_MOVE)
+                {
+                    uint64_t result = 0, turns, hints, hint, deltas = 0;
+                    readVarint(frame, frameEnd, result);
+                    readVarint(frame, frameEnd, turns);
+                    readVarint(frame, frameEnd, hints);
+                    readVarint(frame, frameEnd, hint);
+                    readVarint(frame, frameEnd, deltas);
+                    int value = -1;
+                    for (uint64_t n = 0; n < deltas; n++)
+                    {
+                        uint64_t delta = 0, cellValue = 0;
+                        readVarint(frame, frameEnd, delta);
+                        if ((delta & 3) != DELTA_HIDDEN)
+                        {
+                            readVarint(frame, frameEnd, cellValue);
+                        }
+                        if (int(delta >> 2) == player.pendingCell && (delta & 3) != DELTA_HIDDEN)
+                        {
+                            value = cellValue;
+                        }
+                    }
+                    if (player.pendingCell < 0 || value < 0 || result == MOVE_INVALID || result == MOVE_FORFEIT)
+                    {
+                        ok = false;
+                        return false;
+                    }
+                    ok = seeCard(player, value, us);
+                }
+                else if (type == MSG_CLEARED)
+                {
+                    if (!clearedBoard(player)) return false;
+                }
+                else if (type == MSG_BYE)
+                {
+                    ok = false;
+                }
+            }
+            player.reply.erase(0, at - base);
+            return ok;
+        };
+        auto finish = [&](LoadPlayer& player)
+        {
+            epoll_ctl(poller, EPOLL_CTL_DEL, player.fd, nullptr);
+            ::close(player.fd);
+            player.fd = -1;
+            active--;
+        };
+        epoll_event ready[256];
+        char chunk[16384];
+        while (active > 0)
+        {
+            int count = epoll_wait(poller, ready, 256, 5000);
+            if (count <= 0)
+            {
+                out.errors += active;//server stopped answering
+                break;
+            }
+            for (int e = 0; e < count; e++)
+            {
+                LoadPlayer& player = group[ready[e].data.u32];
+                if (player.fd < 0) continue;
+                ssize_t got;
+                while ((got = recv(player.fd, chunk, sizeof(chunk), 0)) > 0)
+                {
+                    player.reply.append(chunk, got);
+                    out.bytesReceived += got;
+                }
+                if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                {
+                    out.errors++;
+                    finish(player);
+                    continue;
+                }
+                double us = chrono::duration<double, micro>(chrono::steady_clock::now() - player.sentAt).count();
+                bool ok = true;
+                if (!player.greeted)
+                {
+                    if (!endsWithPrompt(player.reply)) continue;
+                    player.greeted = true;
+                    ok = binary ? sendLine(player, "binary\n" + levelChoice()) : sendLine(player, levelChoice());
+                    player.reply.clear();
+                }
+                else if (binary)
+                {
+                    if (!readFrames(player, us, ok) && ok)
+                    {
+                        finish(player);//every board cleared
+                        continue;
+                    }
+                }
+                else
+                {
+                    if (!endsWithPrompt(player.reply)) continue;
+                    if (player.pendingCell < 0)
+                    {
+                        ok = startBoard(player);//board dealt, start mirroring it
+                    }
+                    else
+                    {
+                        int value = frameValue(player.reply, player.mirror.board, values, player.pendingCell);
+                        if (value < 0 || player.reply.find("Invalid") != string::npos)
+                        {
+                            out.errors++;
+                            finish(player);
+                            continue;
+                        }
+                        ok = seeCard(player, value, us);
+                        if (ok && player.reply.find("Congratulations") != string::npos)
+                        {
+                            if (!clearedBoard(player))
+                            {
+                                finish(player);
+                                continue;
+                            }
+                        }
+                    }
+                }
+                if (!ok)
+                {
+                    out.errors++;
+                    finish(player);
+                }
+            }
         }
-        if (!isValidMove(row2 - 1, col2 - 1, true))
+        for (LoadPlayer& player : group)
         {
-            displayWithBorder("Invalid move! Try again.");
-            flipped.erase({row1 - 1, col1 - 1});
-            moveHistory.pop();
-            totalMoves--;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            displayBoard();
-            return true;
+            if (player.fd >= 0)
+            {
+                ::close(player.fd);
+            }
         }
-        flipped.insert({row2 - 1, col2 - 1});
-        moveHistory.push({row2 - 1, col2 - 1});
-        totalMoves++;
-        displayBoard();
-        validTurn = true;
+        ::close(poller);
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int id = 1; id < threadCount; id++)
+    {
+        threads.emplace_back(client, id);
     }
-    if (checkMatch())
+    client(0);
+    for (auto& t : threads)
     {
-        auto it1 = flipped.begin();
-        auto it2 = next(it1);
-        matched.insert(*it1);
-        matched.insert(*it2);
-        flipped.clear();
-        displayWithBorder("Match found!");
+        t.join();
     }
-    else
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    LoadResults total;
+    for (LoadResults& r : results)
     {
-        displayWithBorder("No match. Flipping back...");
-        this_thread::sleep_for(chrono::seconds(1));
-        flipped.clear();
-        displayBoard();
+        total.moveUs.insert(total.moveUs.end(), r.moveUs.begin(), r.moveUs.end());
+        total.turnUs.insert(total.turnUs.end(), r.turnUs.begin(), r.turnUs.end());
+        total.games += r.games;
+        total.errors += r.errors;
+        total.bytesSent += r.bytesSent;
+        total.bytesReceived += r.bytesReceived;
     }
-    turns++;
-    return true;
-}
-
-//count matched cards
-int countMatches()
-{
-    return matched.size();
+    auto percentile = [](vector<double>& v, double q) { return v.empty() ? 0.0 : v[min(v.size() - 1, size_t(q * v.size()))]; };
+    cout << "metric,count,p50_us,p99_us,p999_us,max_us,per_second\n";
+    for (auto* series : {&total.moveUs, &total.turnUs})
+    {
+        vector<double>& v = *series;
+        sort(v.begin(), v.end());
+        cout << (series == &total.moveUs ? "move" : "turn") << "," << v.size() << "," << percentile(v, 0.5) << ","
+             << percentile(v, 0.99) << "," << percentile(v, 0.999) << "," << (v.empty() ? 0.0 : v.back()) << ","
+             << (seconds > 0 ? v.size() / seconds : 0) << "\n";
+    }
+    cout << "# " << connected.load() << " players, " << total.games << " level " << level << " boards cleared, "
+         << total.errors << " errors in " << seconds << " s\n";
+    double turns = max<size_t>(1, total.turnUs.size());
+    cout << "# " << (binary ? "binary" : "text") << " protocol, bytes per turn: " << total.bytesSent / turns << " sent, "
+         << total.bytesReceived / turns << " received\n";
 }
+#endif
 
-//update score in bst
-void updateScore(int level, int turns)
+//time fn until at least 20 ms have passed, returns nanoseconds per call
+template <typename F>
+double timePerCall(F fn, long long& iterations)
 {
-    scoreTree.insertScore(level, turns);
-    auto scores = scoreTree.getScores();
-    for (const auto& score : scores)
+    iterations = 1;
+    while (true)
     {
-        if (score.first == level)
+        auto start = chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; i++)
         {
-            cout << "Best score for Level " << level << ": " << score.second << " turns\n";
-            break;
+            fn();
+        }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        if (ns >= 2e7 || iterations >= (1ll << 40))
+        {
+            return ns / iterations;
         }
+        iterations *= 2;
     }
 }
 
-//provide a hint
-void getHint()
+//time the engine's hot functions on boards from 4x4 to 256x256 and print csv
+void runBenchmarks()
 {
-    if (hintsRemaining <= 0)
-    {
-        displayWithBorder("No hints remaining!");
-        return;
-    }
-    pair<int, int> suggestion = {-1, -1};
-    for (int i = 0; i < currentBoardSize; i++)
+    cout << "version,benchmark,board,cells,iterations,ns_per_op\n";
+    ostream nullSink(nullptr);//discards everything written to it
+    volatile long long sink = 0;//keeps results alive
+    GameSession game;
+    game.rng.seed(2024);
+    bool savedAdjacent = adjacentHints;
+    for (int size = 4; size <= 256; size *= 2)
     {
-        for (int j = 0; j < currentBoardSize; j++)
+        int level = size / 2;
+        int cells = size * size;
+        long long iterations;
+        auto report = [&](const string& name, double ns)
+        {
+            cout << "v4," << name << "," << size << "x" << size << "," << cells << "," << iterations << "," << ns << "\n";
+        };
+        report("initializeGame", timePerCall([&] { initializeGame(game, level); }, iterations));
+        initializeGame(game, level);
+        report("displayBoard", timePerCall([&]
         {
-            pair<int, int> pos = {i, j};
-            if (!flipped.count(pos) && !matched.count(pos))
+            const string& frame = renderBoard(game);
+            nullSink.write(frame.data(), frame.size());
+        }, iterations));
+        if (game.renderer.fixed)
+        {
+            FrameBuilder fixed = game.renderer.fixed;
+            game.renderer.fixed = nullptr;
+            report("displayBoard_runtime", timePerCall([&]
             {
-                int value = board[pos];
-                set<pair<int, int>> visited;
-                suggestion = findMatchRecursive(value, visited, i, j);
-                if (suggestion.first != -1 && suggestion != pos) break;
-            }
+                const string& frame = renderBoard(game);
+                nullSink.write(frame.data(), frame.size());
+            }, iterations));
+            game.renderer.fixed = fixed;
         }
-        if (suggestion.first != -1) break;
-    }
-    if (suggestion.first != -1)
-    {
-        hintsRemaining--;
-        displayWithBorder("Hint: Try card at row " + to_string(suggestion.first + 1) +
-                         ", col " + to_string(suggestion.second + 1) +
-                         " (" + to_string(hintsRemaining) + " hints left)");
-    }
-    else
-    {
-        displayWithBorder("No valid moves available");
-    }
-}
-
-//display game statistics
-void displayStats(int turns)
-{
-    cout << "Game Statistics:\n";
-    cout << "Total Turns: " << turns << "\n";
-    cout << "Total Moves: " << totalMoves << "\n";
-    cout << "Total Matches: " << matched.size() / 2 << "\n";
-    cout << "Hints Used: " << (hintsRemaining - hintsRemaining) << "\n";
-    cout << "Matched Positions:\n";
-    for_each(matched.begin(), matched.end(), [](const pair<int, int>& pos)
-    {
-        cout << "(Row " << pos.first + 1 << ", Col " << pos.second + 1 << ")\n";
-    });
-    cout << "----------------\n";
-}
-
-//show the main menu
-void showMenu()
-{
-    cout << "==== Memory Match Game ====\n";
-    auto scores = scoreTree.getScores();
-    for (int i = 1; i <= MAX_LEVELS; i++)
-    {
-        cout << i << ". Level " << i << " (" << 2*i << "x" << 2*i << ")";
-        for (const auto& score : scores)
+        //probe moves spread over the board
+        vector<pair<int, int>> probes;
+        for (int k = 0; k < 1024; k++)
+        {
+            int idx = game.rng.below(cells);
+            probes.push_back({idx / size, idx % size});
+        }
+        size_t probe = 0;
+        report("isValidMove", timePerCall([&]
+        {
+            auto move = probes[probe++ & 1023];
+            sink += isValidMove(game, move.first, move.second, true);
+        }, iterations));
+        //scan kernels on a board matched up to its last cell, every instruction set this cpu runs
+        CellStates endgame;
+        endgame.reset(cells);
+        for (int idx = 0; idx + 1 < cells; idx++)
+        {
+            endgame.markMatched(idx);
+        }
+        vector<int> row(cells);
+        vector<ScanKernels> kernelSets = {ScanKernels::scalar()};
+        if (scanKernels.name != kernelSets[0].name)
         {
-            if (score.first == i)
+            kernelSets.push_back(scanKernels);
+        }
+        for (const ScanKernels& kernels : kernelSets)
+        {
+            report(string("firstHidden_") + kernels.name, timePerCall([&]
             {
-                cout << " (Best: " << score.second << " turns)";
-                break;
+                sink += kernels.firstHidden(endgame.flippedBits.data(), endgame.matchedBits.data(), cells, 0);
+            }, iterations));
+            report(string("visibleRow_") + kernels.name, timePerCall([&]
+            {
+                kernels.visibleRow(game.board.cells.data(), endgame.flippedBits.data(), endgame.matchedBits.data(), 0, cells, row.data());
+                sink += row[cells / 2];
+            }, iterations));
+        }
+        game.cellStates.flip(0);
+        game.cellStates.flip(1);
+        report("checkMatch", timePerCall([&] { sink += checkMatch(game); }, iterations));
+        game.cellStates.clearFlipped();
+        adjacentHints = false;
+        report("getHint", timePerCall([&] { sink += findHint(game).first; }, iterations));
+        adjacentHints = true;
+        report("getHint_adjacent", timePerCall([&] { sink += findHint(game).first; }, iterations));
+        adjacentHints = savedAdjacent;
+        report("findMatchAdjacent", timePerCall([&]
+        {
+            auto move = probes[probe++ & 1023];
+            sink += findMatchAdjacent(game, game.board.at(move.first, move.second), move.first, move.second).first;
+        }, iterations));
+        //score tree with one entry per cell
+        report("ScoreBST::insertScore", timePerCall([&]
+        {
+            ScoreBST tree;
+            for (int k = 0; k < cells; k++)
+            {
+                tree.insertScore(game.board.cells[k] * 8 + k % 8, k);
             }
+            sink += tree.findBest(1);
+        }, iterations) / cells);
+        ScoreBST tree;
+        for (int k = 0; k < cells; k++)
+        {
+            tree.insertScore(game.board.cells[k] * 8 + k % 8, k);
         }
-        cout << "\n";
-    }
-    cout << "9. Quit\n";
-    cout << "========================\n";
-    displayWithBorder("Select a level: ");
-}
-
-//run a game level
-void runGameLevel(int level, const string& background)
-{
-    initializeGame(level);
-    totalMoves = 0;
-    cout << background << "\n";
-    displayBoard();
-    int turns = 0;
-    while (countMatches() < currentBoardSize * currentBoardSize)
-    {
-        bool continueGame = playTurn(turns);
-        if (!continueGame)
+        report("ScoreBST::getScores", timePerCall([&] { sink += tree.getScores().size(); }, iterations));
+        vector<int> deck;
+        report("mergeSort", timePerCall([&]
         {
-            flipped.clear();
-            matched.clear();
-            moveHistory = queue<pair<int, int>>();
-            hintsRemaining = 0;
-            totalMoves = 0;
-            return;
+            deck = game.board.cells;
+            mergeSort(deck, 0, deck.size() - 1);
+        }, iterations));
+        //whole headless games, dealing included
+        MemoryPlayer memory;
+        report("solve_memory", timePerCall([&] { sink += playHeadlessGame(game, level, memory); }, iterations));
+        MemoryPlayer lru(16, 2024);
+        if (cells <= 4096)
+        {
+            //a small memory needs turns quadratic in the board, so skip the big boards
+            report("solve_lru16", timePerCall([&] { sink += playHeadlessGame(game, level, lru); }, iterations));
         }
+        OraclePlayer oracle;
+        report("solve_oracle", timePerCall([&] { sink += playHeadlessGame(game, level, oracle); }, iterations));
     }
-    cout << "Congratulations! You won Level " << level << " in " << turns << " turns\n";
-    updateScore(level, turns);
-    displayStats(turns);
-    flipped.clear();
-    matched.clear();
-    moveHistory = queue<pair<int, int>>();
-    hintsRemaining = 0;
-    totalMoves = 0;
 }
 
 //level 1: smiley face
-void playLevel1()
+void playLevel1(GameSession& game)
 {
     const string background =
         "Level 1: Smiley Face\n"
@@ -584,11 +4435,11 @@ void playLevel1()
         "        \n"
         "        \n"
         "------------\n";
-    runGameLevel(1, background);
+    runGameLevel(game, 1, background);
 }
 
 //level 2: tree house
-void playLevel2()
+void playLevel2(GameSession& game)
 {
     const string background =
         "Level 2: Tree House\n"
@@ -603,11 +4454,11 @@ void playLevel2()
         "   |______| \n"
         "      ||    \n"
         "-------------\n";
-    runGameLevel(2, background);
+    runGameLevel(game, 2, background);
 }
 
 //level 3: beach
-void playLevel3()
+void playLevel3(GameSession& game)
 {
     const string background =
         "Level 3: Beach\n"
@@ -621,11 +4472,11 @@ void playLevel3()
         "   *         \n"
         "          *  \n"
         "-------------\n";
-    runGameLevel(3, background);
+    runGameLevel(game, 3, background);
 }
 
 //level 4: ocean
-void playLevel4()
+void playLevel4(GameSession& game)
 {
     const string background =
         "Level 4: Ocean\n"
@@ -639,11 +4490,11 @@ void playLevel4()
         "  ~~~~~~~     \n"
         " ~~ ~~~  ~~   \n"
         "~~~~~~~~~~~~  \n";
-    runGameLevel(4, background);
+    runGameLevel(game, 4, background);
 }
 
 //level 5: bright star
-void playLevel5()
+void playLevel5(GameSession& game)
 {
     const string background =
         "Level 5: Bright Star\n"
@@ -657,11 +4508,11 @@ void playLevel5()
         "   ***   ***   \n"
         "  *     *     \n"
         " ***********   \n";
-    runGameLevel(5, background);
+    runGameLevel(game, 5, background);
 }
 
 //level 6: christmas tree
-void playLevel6()
+void playLevel6(GameSession& game)
 {
     const string background =
         "Level 6: Christmas Tree\n"
@@ -676,11 +4527,11 @@ void playLevel6()
         " |  ***  |  \n"
         " |_______|  \n"
         "-------------\n";
-    runGameLevel(6, background);
+    runGameLevel(game, 6, background);
 }
 
 //level 7: bridge
-void playLevel7()
+void playLevel7(GameSession& game)
 {
     const string background =
         "Level 7: Bridge\n"
@@ -695,11 +4546,11 @@ void playLevel7()
         "  |       |  \n"
         "  |       |  \n"
         "-------------\n";
-    runGameLevel(7, background);
+    runGameLevel(game, 7, background);
 }
 
 //level 8: fish
-void playLevel8()
+void playLevel8(GameSession& game)
 {
     const string background =
         "Level 8: Fish\n"
@@ -714,56 +4565,280 @@ void playLevel8()
         "            \n"
         "           \n"
         "-------------\n";
-    runGameLevel(8, background);
+    runGameLevel(game, 8, background);
 }
 
 //main function
-int main()
+int main(int argc, char* argv[])
 {
-    int choice;
+#ifdef MEMORY_MATCH_PROFILE
+    atexit(dumpProfileAtExit);
+#endif
+    int simulateGames = 0;//headless games per level, 0 for interactive play
+    int parGames = -1;//monte-carlo games per board for the par table, -1 to skip it
+    bool serve = false;//host sessions over loopback tcp instead of the console
+    int idleClients = 0;//connections for the idle session test, 0 to skip it
+    int port = 7777;//loopback port the server listens on and the tests connect to
+    int loadPlayers = 0;//simulated players for the load test, 0 to skip it
+    int loadLevel = MAX_LEVELS;//level the load test plays
+    int loadGames = 1;//boards each simulated player clears
+    bool loadBinary = false;//load test speaks the binary protocol
+    long long sortBenchSize = 0;//largest sort benchmark size, 0 to skip
+    bool benchmarks = false;//run the engine microbenchmarks
+    string playerName = "memory";//scripted player for headless games
+    string scoreFile = "scores.dat";//persistent best scores
+    string name = "player";//name best scores are saved under
+    string recordFile;//replay log games are appended to, empty to not record
+    string replayFile;//replay log to re-run instead of playing
+    unsigned masterSeed = random_device{}();//seeds every board dealt this run
+    int threadCount = max(1u, thread::hardware_concurrency());//headless workers
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--adjacent-hints")
+        {
+            adjacentHints = true;
+        }
+        else if (arg == "--ansi")
+        {
+            ansiRender = true;
+        }
+        else if (arg == "--scores" && i + 1 < argc)
+        {
+            scoreFile = argv[++i];
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            replayFile = argv[++i];
+        }
+        else if (arg == "--name" && i + 1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (arg == "--reveal-ms" && i + 1 < argc)
+        {
+            revealMillis = max(0, atoi(argv[++i]));
+        }
+        else if (arg == "--simulate" && i + 1 < argc)
+        {
+            simulateGames = atoi(argv[++i]);
+        }
+        else if (arg == "--par")
+        {
+            parGames = 1000;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+            {
+                parGames = atoi(argv[++i]);
+            }
+        }
+        else if (arg == "--serve")
+        {
+            serve = true;
+        }
+        else if (arg == "--idle-test" && i + 1 < argc)
+        {
+            idleClients = atoi(argv[++i]);
+        }
+        else if (arg == "--load" && i + 1 < argc)
+        {
+            loadPlayers = atoi(argv[++i]);
+        }
+        else if (arg == "--load-level" && i + 1 < argc)
+        {
+            loadLevel = min(MAX_LEVELS, max(1, atoi(argv[++i])));
+        }
+        else if (arg == "--binary")
+        {
+            loadBinary = true;
+        }
+        else if (arg == "--load-games" && i + 1 < argc)
+        {
+            loadGames = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--port" && i + 1 < argc)
+        {
+            port = atoi(argv[++i]);
+        }
+        else if (arg == "--bench")
+        {
+            benchmarks = true;
+        }
+        else if (arg == "--bench-sort")
+        {
+            sortBenchSize = 10000000;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+            {
+                sortBenchSize = atoll(argv[++i]);
+            }
+        }
+        else if (arg == "--player" && i + 1 < argc)
+        {
+            playerName = argv[++i];
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            masterSeed = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            threadCount = max(1, atoi(argv[++i]));
+        }
+    }
+    if (benchmarks)
+    {
+        runBenchmarks();
+        return 0;
+    }
+    if (sortBenchSize > 0)
+    {
+        runSortBenchmark(sortBenchSize);
+        return 0;
+    }
+#ifdef __linux__
+    if (loadPlayers > 0)
+    {
+        runLoadTest(port, loadPlayers, loadLevel, loadGames, threadCount, serve, loadBinary, masterSeed);
+        return 0;
+    }
+    if (serve)
+    {
+        runServer(port, masterSeed, threadCount);
+        return 0;
+    }
+    if (idleClients > 0)
+    {
+        runIdleTest(port, idleClients, 2000);
+        return 0;
+    }
+#endif
+    if (parGames >= 0)
+    {
+        runParTable(parGames, masterSeed, threadCount);
+        return 0;
+    }
+    if (!replayFile.empty())
+    {
+        runReplay(replayFile);
+        return 0;
+    }
+    if (simulateGames > 0)
+    {
+        vector<int> bests(MAX_LEVELS + 1, -1);//saved best per level, -1 if none
+        ScoreStore scoreStore;
+        if (access(scoreFile.c_str(), F_OK) == 0 && scoreStore.open(scoreFile))
+        {
+            for (int level = 1; level <= MAX_LEVELS; level++)
+            {
+                bests[level] = scoreStore.findBest(name, level);
+            }
+        }
+        runSimulation(simulateGames, playerName, masterSeed, threadCount, bests);
+        return 0;
+    }
+    GameSession game;//the interactive player's session
+    game.rng.seed(masterSeed);
+    game.renderer.ansi = ansiRender;
+    game.revealDuration = chrono::milliseconds(revealMillis);
+    if (!recordFile.empty())
+    {
+        game.replayFile = fopen(recordFile.c_str(), "ab");
+        if (!game.replayFile)
+        {
+            displayWithBorder("Could not open " + recordFile + ", games will not be recorded");
+        }
+    }
+    ScoreStore scoreStore;//best scores kept across launches
+    if (scoreStore.open(scoreFile))
+    {
+        game.scoreStore = &scoreStore;
+        game.playerName = name;
+        for (int level = 1; level <= MAX_LEVELS; level++)
+        {
+            int best = scoreStore.findBest(name, level);
+            if (best != -1)
+            {
+                game.scoreTree.insertScore(level, best);
+            }
+        }
+    }
+    else
+    {
+        displayWithBorder("Could not open " + scoreFile + ", scores will not be saved");
+    }
+    int choice = 0;
     while (true)
     {
-        showMenu();
-        cin >> choice;
-        if (choice == 9)
+        showMenu(game);
+        InputStatus status = consoleInput.readInt(choice);
+        if (status != INPUT_OK)
+        {
+            choice = 0;//an unreadable token selects nothing, as a failed cin >> did
+        }
+        if (status == INPUT_EOF || choice == MAX_LEVELS + 1)
         {
             break;
         }
-        if (choice < 1 || choice > 8)
+        if (choice == MAX_LEVELS + 2)
+        {
+            int rows, cols, copies;
+            displayWithBorder("Enter rows, columns and cards per match: ");
+            bool readOk = consoleInput.readInt(rows) == INPUT_OK && consoleInput.readInt(cols) == INPUT_OK &&
+                          consoleInput.readInt(copies) == INPUT_OK;
+            if (readOk && rows >= 1 && cols >= 1 && rows <= MAX_BOARD_SIDE &&
+                cols <= MAX_BOARD_SIDE && copies >= 2 && copies <= rows * cols)
+            {
+                runCustomGame(game, rows, cols, copies);
+            }
+            else
+            {
+                displayWithBorder("Invalid board! Sides must be 1-" + to_string(MAX_BOARD_SIDE) +
+                                  " and at least two cards must fit per match.");
+                consoleInput.skipLine();
+            }
+            continue;
+        }
+        if (status == INPUT_BAD || choice < 1 || choice > MAX_LEVELS)
         {
             displayWithBorder("Invalid choice!");
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            consoleInput.skipLine();
             continue;
         }
         switch (choice)
         {
             case 1:
-                playLevel1();
+                playLevel1(game);
                 break;
             case 2:
-                playLevel2();
+                playLevel2(game);
                 break;
             case 3:
-                playLevel3();
+                playLevel3(game);
                 break;
             case 4:
-                playLevel4();
+                playLevel4(game);
                 break;
             case 5:
-                playLevel5();
+                playLevel5(game);
                 break;
             case 6:
-                playLevel6();
+                playLevel6(game);
                 break;
             case 7:
-                playLevel7();
+                playLevel7(game);
                 break;
             case 8:
-                playLevel8();
+                playLevel8(game);
                 break;
         }
     }
+    if (game.replayFile)
+    {
+        fclose(game.replayFile);
+    }
     cout << "Thanks for playing!\n";
     return 0;
 }
\ No newline at end of file